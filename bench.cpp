@@ -0,0 +1,1056 @@
+#include <iostream>
+#include <ostream>
+#include <iomanip>
+#include <sstream>
+#include <cstdlib>
+#include <cstddef>
+#include <new>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <functional>
+#include <unordered_set>
+#include <set>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include "set.h"
+#include "packed_set.h"
+#include "concurrent_set.h"
+#include "mapped_set.h"
+#include "int_set.h"
+#include "interned_string.h"
+#include "cow_set.h"
+#include "persistent_set.h"
+#include <cstdio>
+
+/*
+  Micro-benchmark di set.
+
+  Per interi, stringhe e punti misura add, cerca, remove, copia,
+  operator==, operator+, operator- e filter_out su dimensioni da 10 a
+  10^7 (o al massimo passato come argomento), per la set senza indice,
+  per la set con indice hash, per packed_set e per std::unordered_set / std::set come
+  riferimento. Per ogni misura stampa i nanosecondi e le allocazioni per
+  operazione. I dati sono generati in modo deterministico, quindi due
+  esecuzioni sulla stessa macchina sono confrontabili.
+  Infine misura unione, intersezione e filter_out paralleli al crescere
+  del numero di thread.
+
+  Le varianti quadratiche vengono saltate quando una misura supererebbe
+  budget_quadratico operazioni elementari.
+
+  Uso: bench.exe [dimensione massima, default 10^6]
+*/
+
+/// numero di allocazioni fatte dal programma
+static std::atomic<unsigned long> allocazioni(0);
+
+#if defined(__GNUC__)
+#define NON_INLINE __attribute__((noinline))
+#else
+#define NON_INLINE
+#endif
+
+/*
+  Tutte le forme sostituite di new e delete passano da queste due
+  funzioni, così ogni allocazione è contata una volta e liberata dalla
+  funzione corrispondente. Non sono inline: altrimenti il compilatore
+  vedrebbe free su memoria avuta da new (-Wmismatched-new-delete).
+*/
+NON_INLINE static void *alloca_contata(std::size_t n)
+{
+  allocazioni.fetch_add(1, std::memory_order_relaxed);
+  void *p = std::malloc(n == 0 ? 1 : n);
+  if (p == nullptr)
+    throw std::bad_alloc();
+  return p;
+}
+
+NON_INLINE static void libera_contata(void *p) noexcept
+{
+  std::free(p);
+}
+
+void *operator new(std::size_t n)
+{
+  return alloca_contata(n);
+}
+
+void *operator new[](std::size_t n)
+{
+  return alloca_contata(n);
+}
+
+void operator delete(void *p) noexcept
+{
+  libera_contata(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+  libera_contata(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+  libera_contata(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept
+{
+  libera_contata(p);
+}
+
+/**
+ * @brief Funtore di uguaglianza tra tipi interi
+ */
+struct confronto_interi
+{
+  bool operator()(int a, int b) const
+  {
+    return a == b;
+  }
+};
+
+/**
+ * @brief Funtore di uguaglianza tra tipi stringhe
+ */
+struct confronto_stringhe
+{
+  bool operator()(const std::string &a, const std::string &b) const
+  {
+    return (a == b);
+  }
+};
+
+/**
+ * @brief Struttura del punto
+ * Punto a due dimensioni, come quello dei test
+ */
+struct punto
+{
+  int x; ///< coordinata x del punto
+  int y; ///< coordinata y del punto
+
+  punto() : x(0), y(0) {}
+  punto(int xx, int yy) : x(xx), y(yy) {}
+
+  bool operator==(const punto &other) const
+  {
+    return x == other.x && y == other.y;
+  }
+
+  bool operator<(const punto &other) const
+  {
+    return x < other.x || (x == other.x && y < other.y);
+  }
+
+  friend std::ostream &operator<<(std::ostream &os, const punto &p)
+  {
+    os << "(" << p.x << "," << p.y << ")";
+    return os;
+  }
+};
+
+/**
+ * @brief Funtore di uguaglianza tra tipi punto
+ */
+struct confronto_punti
+{
+  bool operator()(const punto &p1, const punto &p2) const
+  {
+    return (p1.x == p2.x && p1.y == p2.y);
+  }
+};
+
+/**
+ * @brief Funtore di hash per i punti
+ */
+struct hash_punti
+{
+  std::size_t operator()(const punto &p) const
+  {
+    std::size_t h = static_cast<unsigned int>(p.x);
+    return h * 1000003u ^ static_cast<unsigned int>(p.y);
+  }
+};
+
+template <>
+struct confronto_bit_a_bit<confronto_interi> : std::true_type
+{
+};
+
+template <>
+struct confronto_bit_a_bit<confronto_punti> : std::true_type
+{
+};
+
+/**
+ * @brief Generatore pseudo-casuale xorshift64
+ * Deterministico e indipendente dalla libreria standard
+ */
+struct generatore
+{
+  unsigned long long stato; ///< stato del generatore
+
+  explicit generatore(unsigned long long seme) : stato(seme) {}
+
+  unsigned long long operator()()
+  {
+    stato ^= stato << 13;
+    stato ^= stato >> 7;
+    stato ^= stato << 17;
+    return stato;
+  }
+};
+
+/**
+ * @brief Dati di prova per ogni tipo
+ * Genera n valori distinti (chiavi) e n valori in gran parte assenti
+ */
+template <typename T>
+struct dati;
+
+template <>
+struct dati<int>
+{
+  static const char *nome() { return "int"; }
+  static int valore(unsigned long long k) { return static_cast<int>(k * 2654435761ULL); }
+  static bool pari(const int &v) { return v % 2 == 0; }
+};
+
+template <>
+struct dati<std::string>
+{
+  static const char *nome() { return "string"; }
+  static std::string valore(unsigned long long k)
+  {
+    std::ostringstream os;
+    os << "https://www.example.com/catalogo/prodotti/" << k;
+    return os.str();
+  }
+  static bool pari(const std::string &v) { return v.size() % 2 == 0; }
+};
+
+template <>
+struct dati<punto>
+{
+  static const char *nome() { return "punto"; }
+  static punto valore(unsigned long long k)
+  {
+    return punto(static_cast<int>(k & 0xffff), static_cast<int>(k >> 16));
+  }
+  static bool pari(const punto &v) { return v.x % 2 == 0; }
+};
+
+/**
+ * @brief Predicato per filter_out
+ */
+template <typename T>
+struct filtro
+{
+  bool operator()(const T &v) const
+  {
+    return dati<T>::pari(v);
+  }
+};
+
+/**
+ * @brief Risultato di una misura
+ */
+struct misura
+{
+  double ns;      ///< nanosecondi per operazione
+  double alloc;   ///< allocazioni per operazione
+  bool eseguita;  ///< false se la misura è stata saltata
+};
+
+/**
+ * @brief Esegue una funzione più volte e ne misura il costo
+ * @param f funzione da misurare, chiamata rip volte
+ * @param rip ripetizioni
+ * @param ops operazioni per ripetizione
+ * @return tempo e allocazioni per operazione
+ */
+template <typename F>
+misura cronometra(F f, unsigned long rip, unsigned long ops)
+{
+  unsigned long a0 = allocazioni.load();
+  std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+  for (unsigned long r = 0; r < rip; ++r)
+    f();
+  std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+  unsigned long a1 = allocazioni.load();
+  double totale = static_cast<double>(rip) * (ops == 0 ? 1 : ops);
+  misura m;
+  m.ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / totale;
+  m.alloc = (a1 - a0) / totale;
+  m.eseguita = true;
+  return m;
+}
+
+/**
+ * @brief Stampa una riga del risultato
+ */
+void stampa(const char *tipo, const char *struttura, const char *operazione, unsigned long n, const misura &m)
+{
+  std::cout << std::left << std::setw(8) << tipo << std::setw(16) << struttura
+            << std::setw(12) << operazione << std::right << std::setw(10) << n;
+  if (m.eseguita)
+    std::cout << std::fixed << std::setprecision(1) << std::setw(14) << m.ns
+              << std::setprecision(3) << std::setw(12) << m.alloc;
+  else
+    std::cout << std::setw(14) << "-" << std::setw(12) << "-";
+  std::cout << std::endl;
+}
+
+/// limite di operazioni elementari per una singola misura quadratica
+static const double budget_quadratico = 2e9;
+
+/// numero di operazioni da cronometrare per ogni misura
+static const unsigned long operazioni_minime = 1000000;
+
+/**
+ * @brief Ripetizioni necessarie per arrivare a operazioni_minime
+ */
+unsigned long ripetizioni(unsigned long n)
+{
+  return n >= operazioni_minime ? 1 : operazioni_minime / n;
+}
+
+/**
+ * @brief Misura tutte le operazioni di una set
+ * @param struttura nome della variante
+ * @param quadratica true se le operazioni scorrono la lista (nessun indice)
+ * @param chiavi elementi da inserire
+ * @param altre elementi da cercare, metà presenti e metà no
+ */
+template <typename S, typename T>
+void misura_set(const char *struttura, bool quadratica, const std::vector<T> &chiavi, const std::vector<T> &altre)
+{
+  unsigned long n = chiavi.size();
+  const char *tipo = dati<T>::nome();
+  misura saltata = {0, 0, false};
+  bool troppo = quadratica && static_cast<double>(n) * n / 2 > budget_quadratico;
+  unsigned long rip = ripetizioni(n);
+  if (quadratica)
+    rip = std::max(1UL, std::min(rip, static_cast<unsigned long>(1e7 / (static_cast<double>(n) * n))));
+
+  S s;
+  for (unsigned long i = 0; i < n && !troppo; ++i)
+    s.add(chiavi[i]);
+  S meta;
+  for (unsigned long i = 0; i < n / 2 && !troppo; ++i)
+    meta.add(chiavi[i]);
+  meta.insert(altre.begin(), altre.begin() + (troppo ? 0 : n / 2));
+
+  if (troppo)
+  {
+    const char *op[] = {"add", "cerca", "remove", "copia", "==", "+", "-", "filter_out"};
+    for (int i = 0; i < 8; ++i)
+      stampa(tipo, struttura, op[i], n, saltata);
+    return;
+  }
+
+  stampa(tipo, struttura, "add", n, cronometra([&]() {
+           S t;
+           for (unsigned long i = 0; i < n; ++i)
+             t.add(chiavi[i]);
+         },
+                                              rip, n));
+
+  volatile unsigned long trovati = 0;
+  stampa(tipo, struttura, "cerca", n, cronometra([&]() {
+           for (unsigned long i = 0; i < n; ++i)
+             trovati = trovati + s.cerca(i % 2 ? chiavi[i] : altre[i]);
+         },
+                                                rip, n));
+
+  stampa(tipo, struttura, "remove", n, cronometra([&]() {
+           S t(s);
+           for (unsigned long i = 0; i < n; ++i)
+             t.remove(chiavi[i]);
+         },
+                                                 rip, n));
+
+  stampa(tipo, struttura, "copia", n, cronometra([&]() {
+           S t(s);
+           trovati = trovati + t.size();
+         },
+                                                rip, n));
+
+  S copia(s);
+  stampa(tipo, struttura, "==", n, cronometra([&]() { trovati = trovati + (s == copia); }, rip, n));
+  stampa(tipo, struttura, "+", n, cronometra([&]() {
+           S t = s + meta;
+           trovati = trovati + t.size();
+         },
+                                                rip, n));
+  stampa(tipo, struttura, "-", n, cronometra([&]() {
+           S t = s - meta;
+           trovati = trovati + t.size();
+         },
+                                                rip, n));
+  stampa(tipo, struttura, "filter_out", n, cronometra([&]() { trovati = trovati + filter_out(s, filtro<T>()).size(); }, rip, n));
+}
+
+/**
+ * @brief Misura le stesse operazioni su un contenitore della libreria standard
+ * @param struttura nome del contenitore
+ * @param chiavi elementi da inserire
+ * @param altre elementi da cercare, metà presenti e metà no
+ */
+template <typename C, typename T>
+void misura_std(const char *struttura, const std::vector<T> &chiavi, const std::vector<T> &altre)
+{
+  unsigned long n = chiavi.size();
+  const char *tipo = dati<T>::nome();
+  unsigned long rip = ripetizioni(n);
+
+  C s(chiavi.begin(), chiavi.end());
+  C meta(chiavi.begin(), chiavi.begin() + n / 2);
+  meta.insert(altre.begin(), altre.begin() + n / 2);
+
+  stampa(tipo, struttura, "add", n, cronometra([&]() {
+           C t;
+           for (unsigned long i = 0; i < n; ++i)
+             t.insert(chiavi[i]);
+         },
+                                              rip, n));
+
+  volatile unsigned long trovati = 0;
+  stampa(tipo, struttura, "cerca", n, cronometra([&]() {
+           for (unsigned long i = 0; i < n; ++i)
+             trovati = trovati + s.count(i % 2 ? chiavi[i] : altre[i]);
+         },
+                                                rip, n));
+
+  stampa(tipo, struttura, "remove", n, cronometra([&]() {
+           C t(s);
+           for (unsigned long i = 0; i < n; ++i)
+             t.erase(chiavi[i]);
+         },
+                                                 rip, n));
+
+  stampa(tipo, struttura, "copia", n, cronometra([&]() {
+           C t(s);
+           trovati = trovati + t.size();
+         },
+                                                rip, n));
+
+  C copia(s);
+  stampa(tipo, struttura, "==", n, cronometra([&]() { trovati = trovati + (s == copia); }, rip, n));
+  stampa(tipo, struttura, "+", n, cronometra([&]() {
+           C t(s);
+           t.insert(meta.begin(), meta.end());
+           trovati = trovati + t.size();
+         },
+                                            rip, n));
+  stampa(tipo, struttura, "-", n, cronometra([&]() {
+           C t;
+           for (typename C::const_iterator i = s.begin(); i != s.end(); ++i)
+             if (meta.count(*i))
+               t.insert(*i);
+           trovati = trovati + t.size();
+         },
+                                            rip, n));
+  stampa(tipo, struttura, "filter_out", n, cronometra([&]() {
+           C t;
+           for (typename C::const_iterator i = s.begin(); i != s.end(); ++i)
+             if (filtro<T>()(*i))
+               t.insert(*i);
+           trovati = trovati + t.size();
+         },
+                                                     rip, n));
+}
+
+/**
+ * @brief Misura tutte le varianti per un tipo di elemento
+ * @tparam T tipo degli elementi
+ * @tparam Eql funtore di uguaglianza
+ * @tparam Hash funtore di hash
+ * @param massimo dimensione massima
+ */
+template <typename T, typename Eql, typename Hash>
+void misura_tipo(unsigned long massimo)
+{
+  for (unsigned long n = 10; n <= massimo; n *= 10)
+  {
+    generatore g(n);
+    std::vector<T> chiavi, altre;
+    chiavi.reserve(n);
+    altre.reserve(n);
+    for (unsigned long i = 0; i < n; ++i)
+    {
+      chiavi.push_back(dati<T>::valore(i));
+      altre.push_back(dati<T>::valore(n + (g() % (4 * n))));
+    }
+    misura_set<set<T, Eql>, T>("set", true, chiavi, altre);
+    misura_set<set<T, Eql, Hash>, T>("set+hash", false, chiavi, altre);
+    misura_set<packed_set<T, Eql>, T>("packed_set", true, chiavi, altre);
+    misura_std<std::unordered_set<T, Hash>, T>("unordered_set", chiavi, altre);
+    misura_std<std::set<T>, T>("std::set", chiavi, altre);
+  }
+}
+
+/**
+ * @brief Misura unione, intersezione e filter_out paralleli
+ * Per 1, 2, 4, ... thread fino al numero di core, così si vede
+ * l'accelerazione rispetto al caso a un thread.
+ * @param struttura nome della variante
+ * @param n numero di elementi di ciascun operando
+ */
+template <typename S>
+void misura_parallelo(const char *struttura, unsigned long n)
+{
+  S s1, s2;
+  for (unsigned long i = 0; i < n; ++i)
+  {
+    s1.add(dati<int>::valore(i));
+    s2.add(dati<int>::valore(i + n / 2));
+  }
+  unsigned int core = std::max(1u, std::thread::hardware_concurrency());
+  volatile unsigned long trovati = 0;
+  for (unsigned int t = 1;; t *= 2)
+  {
+    t = std::min(t, core);
+    parallelo p(t);
+    std::ostringstream nome;
+    nome << struttura << "/" << t << "t";
+    std::string str = nome.str();
+    stampa("int", str.c_str(), "unione", n, cronometra([&]() { trovati = trovati + unione(p, s1, s2).size(); }, 1, n));
+    stampa("int", str.c_str(), "intersez.", n, cronometra([&]() { trovati = trovati + intersezione(p, s1, s2).size(); }, 1, n));
+    stampa("int", str.c_str(), "filter_out", n, cronometra([&]() { trovati = trovati + filter_out(p, s1, filtro<int>()).size(); }, 1, n));
+    if (t == core)
+      break;
+  }
+}
+
+/**
+ * @brief set protetta da un unico mutex
+ * Termine di paragone per concurrent_set: tutti i thread si contendono
+ * lo stesso lock.
+ */
+template <typename T, typename Eql, typename Hash>
+class set_bloccata
+{
+  set<T, Eql, Hash> _s;
+  mutable std::mutex _lock;
+
+public:
+  bool add(const T &v)
+  {
+    std::lock_guard<std::mutex> guardia(_lock);
+    unsigned int prima = _s.size();
+    _s.add(v);
+    return _s.size() != prima;
+  }
+
+  bool remove(const T &v)
+  {
+    std::lock_guard<std::mutex> guardia(_lock);
+    unsigned int prima = _s.size();
+    _s.remove(v);
+    return _s.size() != prima;
+  }
+
+  bool cerca(const T &v) const
+  {
+    std::lock_guard<std::mutex> guardia(_lock);
+    return _s.cerca(v);
+  }
+};
+
+/**
+ * @brief Misura il throughput con più thread che scrivono e leggono
+ * Ogni thread esegue n operazioni (10% add, 10% remove, 80% cerca) su
+ * chiavi casuali; il tempo riportato è per operazione complessiva, quindi
+ * se la struttura scala deve scendere al crescere dei thread.
+ * @param struttura nome della variante
+ * @param n operazioni per thread e dimensione iniziale dell'insieme
+ */
+template <typename S>
+void misura_concorrente(const char *struttura, unsigned long n)
+{
+  unsigned int core = std::max(1u, std::thread::hardware_concurrency());
+  for (unsigned int t = 1;; t *= 2)
+  {
+    t = std::min(t, core);
+    S s;
+    for (unsigned long i = 0; i < n; ++i)
+      s.add(dati<int>::valore(i));
+    std::atomic<unsigned long> trovati(0);
+    std::ostringstream nome;
+    nome << struttura << "/" << t << "t";
+    std::string str = nome.str();
+    stampa("int", str.c_str(), "misto", n, cronometra([&]() {
+             std::vector<std::thread> thread;
+             for (unsigned int k = 0; k < t; ++k)
+               thread.push_back(std::thread([&s, &trovati, n, k]() {
+                 generatore g(k + 1);
+                 unsigned long tr = 0;
+                 for (unsigned long i = 0; i < n; ++i)
+                 {
+                   int v = dati<int>::valore(g() % (2 * n));
+                   switch (i % 10)
+                   {
+                   case 0:
+                     tr += s.add(v);
+                     break;
+                   case 1:
+                     tr += s.remove(v);
+                     break;
+                   default:
+                     tr += s.cerca(v);
+                   }
+                 }
+                 trovati += tr;
+               }));
+             for (unsigned int k = 0; k < t; ++k)
+               thread[k].join();
+           },
+                                                       1, static_cast<unsigned long>(t) * n));
+    if (t == core)
+      break;
+  }
+}
+
+/**
+ * @brief Misura cerca di valori assenti con e senza prefiltro
+ * @param struttura nome della variante
+ * @param n numero di elementi
+ * @param abilita funzione che abilita il prefiltro sulla set
+ */
+template <typename S, typename F>
+void misura_prefiltro(const char *struttura, unsigned long n, F abilita)
+{
+  S s;
+  for (unsigned long i = 0; i < n; ++i)
+    s.add(dati<int>::valore(i));
+  std::vector<int> assenti;
+  for (unsigned long i = 0; i < n; ++i)
+    assenti.push_back(dati<int>::valore(n + i));
+  volatile unsigned long trovati = 0;
+  unsigned long rip = ripetizioni(n);
+  std::string nome = std::string(struttura);
+  stampa("int", nome.c_str(), "cerca ass.", n, cronometra([&]() {
+           for (unsigned long i = 0; i < n; ++i)
+             trovati = trovati + s.cerca(assenti[i]);
+         },
+                                                          rip, n));
+  abilita(s);
+  nome += "+bloom";
+  stampa("int", nome.c_str(), "cerca ass.", n, cronometra([&]() {
+           for (unsigned long i = 0; i < n; ++i)
+             trovati = trovati + s.cerca(assenti[i]);
+         },
+                                                          rip, n));
+}
+
+/**
+ * @brief Misura le operazioni batch contro quelle su una chiave alla volta
+ * @param struttura nome della variante
+ * @param n numero di elementi e di chiavi
+ */
+template <typename S>
+void misura_batch(const char *struttura, unsigned long n)
+{
+  std::vector<int> chiavi, cercate;
+  generatore g(n);
+  for (unsigned long i = 0; i < n; ++i)
+  {
+    chiavi.push_back(dati<int>::valore(i));
+    cercate.push_back(dati<int>::valore(g() % (2 * n)));
+  }
+  S s;
+  s.add_batch(chiavi.begin(), chiavi.end());
+  volatile unsigned long trovati = 0;
+  unsigned long rip = ripetizioni(n);
+  std::string nome = std::string(struttura) + "/batch";
+  stampa("int", struttura, "cerca", n, cronometra([&]() {
+           for (unsigned long i = 0; i < n; ++i)
+             trovati = trovati + s.cerca(cercate[i]);
+         },
+                                                    rip, n));
+  stampa("int", nome.c_str(), "cerca", n, cronometra([&]() {
+           std::vector<bool> esito = s.cerca_batch(cercate.begin(), cercate.end());
+           trovati = trovati + esito.size();
+         },
+                                                        rip, n));
+  stampa("int", struttura, "add", n, cronometra([&]() {
+           S t;
+           for (unsigned long i = 0; i < n; ++i)
+             t.add(chiavi[i]);
+           trovati = trovati + t.size();
+         },
+                                                  rip, n));
+  stampa("int", nome.c_str(), "add", n, cronometra([&]() {
+           S t;
+           t.add_batch(chiavi.begin(), chiavi.end());
+           trovati = trovati + t.size();
+         },
+                                                      rip, n));
+  stampa("int", struttura, "remove", n, cronometra([&]() {
+           S t(s);
+           for (unsigned long i = 0; i < n; ++i)
+             t.remove(cercate[i]);
+           trovati = trovati + t.size();
+         },
+                                                     rip, n));
+  stampa("int", nome.c_str(), "remove", n, cronometra([&]() {
+           S t(s);
+           t.remove_batch(cercate.begin(), cercate.end());
+           trovati = trovati + t.size();
+         },
+                                                         rip, n));
+}
+
+/**
+ * @brief Misura l'avvio da file contro la ricostruzione con add
+ * @param n numero di elementi
+ */
+template <typename T, typename Eql, typename Hash>
+void misura_avvio(unsigned long n)
+{
+  typedef set<T, Eql, Hash> S;
+  const char *file = "bench_mapped.bin";
+  std::vector<T> chiavi;
+  for (unsigned long i = 0; i < n; ++i)
+    chiavi.push_back(dati<T>::valore(i));
+  S s;
+  for (unsigned long i = 0; i < n; ++i)
+    s.add(chiavi[i]);
+  salva(s, file);
+  volatile unsigned long trovati = 0;
+  unsigned long rip = ripetizioni(n);
+  const char *tipo = dati<T>::nome();
+  stampa(tipo, "set+hash", "ricostruisci", n, cronometra([&]() {
+           S t;
+           for (unsigned long i = 0; i < n; ++i)
+             t.add(chiavi[i]);
+           trovati = trovati + t.size();
+         },
+                                                          rip, n));
+  stampa(tipo, "set+hash", "carica", n, cronometra([&]() {
+           S t;
+           carica(t, file);
+           trovati = trovati + t.size();
+         },
+                                                    rip, n));
+  stampa(tipo, "mapped", "apri", n, cronometra([&]() {
+           mapped_set<T, Eql, Hash> m(file);
+           trovati = trovati + m.cerca(chiavi[n / 2]);
+         },
+                                                rip, n));
+  mapped_set<T, Eql, Hash> m(file);
+  stampa(tipo, "mapped", "cerca", n, cronometra([&]() {
+           for (unsigned long i = 0; i < n; ++i)
+             trovati = trovati + m.cerca(chiavi[i]);
+         },
+                                                 rip, n));
+  std::remove(file);
+}
+
+/**
+ * @brief Misura la scrittura su stream elemento per elemento e con write_to
+ * @param n numero di elementi
+ */
+template <typename T, typename Eql, typename Hash>
+void misura_scrittura(unsigned long n)
+{
+  set<T, Eql, Hash> s;
+  for (unsigned long i = 0; i < n; ++i)
+    s.add(dati<T>::valore(i * 2654435761ULL));
+  volatile unsigned long byte = 0;
+  unsigned long rip = ripetizioni(n);
+  const char *tipo = dati<T>::nome();
+  stampa(tipo, "set+hash", "os<<", n, cronometra([&]() {
+           std::ostringstream os;
+           for (typename set<T, Eql, Hash>::const_iterator i = s.begin(), e = s.end(); i != e; ++i)
+             os << *i << " ";
+           byte = byte + os.tellp();
+         },
+                                                  rip, n));
+  stampa(tipo, "set+hash", "write_to", n, cronometra([&]() {
+           std::ostringstream os;
+           s.write_to(os);
+           byte = byte + os.tellp();
+         },
+                                                      rip, n));
+}
+
+/**
+ * @brief Misura int_set contro set con Hash
+ * Con chiavi dense (0..n-1), dove int_set usa le bitmap, e con le
+ * chiavi sparse delle altre misure fino a 100000 elementi, dove usa
+ * gli array.
+ */
+void misura_int_set(unsigned long massimo)
+{
+  for (unsigned long n = 10; n <= massimo; n *= 10)
+  {
+    generatore g(n);
+    std::vector<int> dense, altre_dense, sparse, altre_sparse;
+    for (unsigned long i = 0; i < n; ++i)
+    {
+      dense.push_back(static_cast<int>(i));
+      altre_dense.push_back(static_cast<int>(n / 2 + g() % n));
+      sparse.push_back(dati<int>::valore(i));
+      altre_sparse.push_back(dati<int>::valore(n + (g() % (4 * n))));
+    }
+    misura_set<set<int, confronto_interi, std::hash<int> >, int>("set+hash/densi", false, dense, altre_dense);
+    misura_set<int_set, int>("int_set/densi", false, dense, altre_dense);
+    // sparse su tutti gli int: un contenitore per valore, add e remove lineari
+    if (n <= 100000)
+      misura_set<int_set, int>("int_set", false, sparse, altre_sparse);
+  }
+}
+
+/**
+ * @brief Misura creazione, copia e distruzione di molte set piccole
+ * @param struttura nome della variante
+ * @param k elementi di ogni set
+ */
+template <typename S>
+void misura_piccole(const char *struttura, unsigned long k)
+{
+  const unsigned long n = 100000;
+  volatile unsigned long trovati = 0;
+  stampa("int", struttura, "crea", k, cronometra([&]() {
+           for (unsigned long i = 0; i < n; ++i)
+           {
+             S s;
+             for (unsigned long j = 0; j < k; ++j)
+               s.add(static_cast<int>(i + j));
+             trovati = trovati + s.cerca(static_cast<int>(i));
+           }
+         },
+                                                 1, n));
+  S s;
+  for (unsigned long j = 0; j < k; ++j)
+    s.add(static_cast<int>(j));
+  stampa("int", struttura, "copia", k, cronometra([&]() {
+           for (unsigned long i = 0; i < n; ++i)
+           {
+             S t(s);
+             trovati = trovati + t.size();
+           }
+         },
+                                                  1, n));
+}
+
+/**
+ * @brief Misura set di URL lunghi con prefisso comune
+ * Stringhe con Hash contro stringhe internate: con le internate
+ * uguaglianza e hash non leggono i caratteri.
+ * @param n numero di URL
+ */
+void misura_url(unsigned long n)
+{
+  typedef set<std::string, confronto_stringhe, std::hash<std::string> > S;
+  typedef set<stringa_internata, confronto_internate, hash_internate> I;
+  tabella_stringhe tabella;
+  std::vector<std::string> url;
+  std::vector<stringa_internata> internate;
+  for (unsigned long i = 0; i < n; ++i)
+  {
+    std::ostringstream os;
+    os << "https://www.esempio.it/catalogo/prodotti/categoria/sottocategoria/articolo?id=" << dati<int>::valore(i);
+    url.push_back(os.str());
+    internate.push_back(tabella.interna(url.back()));
+  }
+  volatile unsigned long trovati = 0;
+  unsigned long rip = ripetizioni(n);
+  S s(url.begin(), url.end());
+  I si(internate.begin(), internate.end());
+  S meta(url.begin(), url.begin() + n / 2);
+  I meta_i(internate.begin(), internate.begin() + n / 2);
+  stampa("url", "set+hash", "add", n, cronometra([&]() {
+           S t;
+           for (unsigned long i = 0; i < n; ++i)
+             t.add(url[i]);
+           trovati = trovati + t.size();
+         },
+                                             rip, n));
+  stampa("url", "internate", "add", n, cronometra([&]() {
+           I t;
+           for (unsigned long i = 0; i < n; ++i)
+             t.add(internate[i]);
+           trovati = trovati + t.size();
+         },
+                                              rip, n));
+  stampa("url", "set+hash", "cerca", n, cronometra([&]() {
+           for (unsigned long i = 0; i < n; ++i)
+             trovati = trovati + s.cerca(url[i]);
+         },
+                                               rip, n));
+  stampa("url", "internate", "cerca", n, cronometra([&]() {
+           for (unsigned long i = 0; i < n; ++i)
+             trovati = trovati + si.cerca(internate[i]);
+         },
+                                                rip, n));
+  stampa("url", "set+hash", "differenza", n, cronometra([&]() { trovati = trovati + differenza(s, meta).size(); }, rip, n));
+  stampa("url", "internate", "differenza", n, cronometra([&]() { trovati = trovati + differenza(si, meta_i).size(); }, rip, n));
+}
+
+/**
+ * @brief Misura il confronto tra set della stessa dimensione
+ * Con Hash le set diverse vengono scartate dall'impronta senza percorrerle,
+ * quelle uguali (inserite in ordine inverso) sono confermate in O(n).
+ * @param n numero di elementi
+ */
+void misura_uguaglianza(unsigned long n)
+{
+  typedef set<int, confronto_interi, std::hash<int> > S;
+  S a, b, c;
+  for (unsigned long i = 0; i < n; ++i)
+  {
+    a.add(dati<int>::valore(i));
+    b.add(dati<int>::valore(n - 1 - i));
+    c.add(dati<int>::valore(i == 0 ? n : i));
+  }
+  volatile unsigned long uguali = 0;
+  unsigned long rip = ripetizioni(n);
+  stampa("int", "set+hash", "== uguali", n, cronometra([&]() { uguali = uguali + (a == b); }, rip, n));
+  stampa("int", "set+hash", "== diverse", n, cronometra([&]() { uguali = uguali + (a == c); }, rip, n));
+  stampa("int", "set+hash", "std::hash", n, cronometra([&]() { uguali = uguali + std::hash<S>()(a) % 2; }, rip, n));
+}
+
+/**
+ * @brief Misura copie di una set lette molto più spesso che modificate
+ * Ogni copia legge un elemento e una su cento ne aggiunge uno: la set
+ * viene copiata ogni volta, la cow_set solo alle modifiche.
+ * @param n numero di elementi
+ */
+void misura_cow(unsigned long n)
+{
+  typedef set<int, confronto_interi, std::hash<int> > S;
+  typedef cow_set<int, confronto_interi, std::hash<int> > C;
+  S s;
+  for (unsigned long i = 0; i < n; ++i)
+    s.add(dati<int>::valore(i));
+  C c(s);
+  const unsigned long copie = 1000;
+  volatile unsigned long trovati = 0;
+  stampa("int", "set+hash", "copia", n, cronometra([&]() {
+           for (unsigned long i = 0; i < copie; ++i)
+           {
+             S t(s);
+             if (i % 100 == 0)
+               t.add(-1);
+             trovati = trovati + t.cerca(dati<int>::valore(i % n));
+           }
+         },
+                                               1, copie));
+  stampa("int", "cow_set", "copia", n, cronometra([&]() {
+           for (unsigned long i = 0; i < copie; ++i)
+           {
+             C t(c);
+             if (i % 100 == 0)
+               t.add(-1);
+             trovati = trovati + t.cerca(dati<int>::valore(i % n));
+           }
+         },
+                                              1, copie));
+}
+
+/**
+ * @brief Misura la creazione di versioni di un insieme
+ * Ogni versione aggiunge un elemento a quella precedente e tutte restano
+ * disponibili: la set va copiata ogni volta, la persistent_set copia solo
+ * il cammino dell'elemento.
+ * @param n elementi della prima versione
+ */
+void misura_versioni(unsigned long n)
+{
+  typedef set<int, confronto_interi, std::hash<int> > S;
+  typedef persistent_set<int, confronto_interi, std::hash<int> > P;
+  std::vector<int> v;
+  for (unsigned long i = 0; i < n; ++i)
+    v.push_back(dati<int>::valore(i));
+  S s(v.begin(), v.end());
+  P p(v.begin(), v.end());
+  const unsigned long versioni = 100;
+  volatile unsigned long trovati = 0;
+  stampa("int", "set+hash", "versione", n, cronometra([&]() {
+           std::vector<S> storia(1, s);
+           for (unsigned long i = 0; i < versioni; ++i)
+           {
+             storia.push_back(storia.back());
+             storia.back().add(-1 - static_cast<int>(i));
+           }
+           trovati = trovati + storia.back().size();
+         },
+                                                  1, versioni));
+  stampa("int", "persistent", "versione", n, cronometra([&]() {
+           std::vector<P> storia(1, p);
+           for (unsigned long i = 0; i < versioni; ++i)
+             storia.push_back(storia.back().add(-1 - static_cast<int>(i)));
+           trovati = trovati + storia.back().size();
+         },
+                                                    1, versioni));
+  unsigned long rip = ripetizioni(n);
+  stampa("int", "persistent", "cerca", n, cronometra([&]() {
+           for (unsigned long i = 0; i < n; ++i)
+             trovati = trovati + p.cerca(v[i]);
+         },
+                                                 rip, n));
+  P q = p.add(-1).remove(v[0]);
+  stampa("int", "persistent", "== versioni", n, cronometra([&]() { trovati = trovati + (p == q); }, rip, 1));
+}
+
+int main(int argc, char *argv[])
+{
+  unsigned long massimo = 1000000;
+  if (argc > 1)
+    massimo = std::strtoul(argv[1], nullptr, 10);
+
+  std::cout << std::left << std::setw(8) << "tipo" << std::setw(16) << "struttura"
+            << std::setw(12) << "operazione" << std::right << std::setw(10) << "n"
+            << std::setw(14) << "ns/op" << std::setw(12) << "alloc/op" << std::endl;
+
+  misura_tipo<int, confronto_interi, std::hash<int> >(massimo);
+  misura_tipo<std::string, confronto_stringhe, std::hash<std::string> >(massimo);
+  misura_tipo<punto, confronto_punti, hash_punti>(massimo);
+
+  misura_int_set(massimo);
+  misura_url(massimo);
+  misura_uguaglianza(massimo);
+  for (unsigned long k = 100; k <= std::min(massimo, 10000UL); k *= 100)
+    misura_cow(k);
+  for (unsigned long k = 1000; k <= std::min(massimo, 100000UL); k *= 10)
+    misura_versioni(k);
+
+  for (unsigned long k = 2; k <= 8; k *= 2)
+  {
+    misura_piccole<set<int, confronto_interi, std::hash<int> > >("set+hash", k);
+    misura_piccole<set<int, confronto_interi, std::hash<int>, senza_statistiche, 8> >("set+hash<8>", k);
+  }
+
+  misura_parallelo<set<int, confronto_interi> >("set", std::min(massimo, 20000UL));
+  misura_parallelo<set<int, confronto_interi, std::hash<int> > >("set+hash", massimo);
+
+  misura_concorrente<set_bloccata<int, confronto_interi, std::hash<int> > >("set+mutex", massimo);
+  misura_concorrente<concurrent_set<int, confronto_interi, std::hash<int> > >("concurrent", massimo);
+
+  misura_prefiltro<set<int, confronto_interi> >("set", std::min(massimo, 10000UL), [](set<int, confronto_interi> &s) {
+    s.abilita_prefiltro(0.01, std::hash<int>());
+  });
+  misura_prefiltro<set<int, confronto_interi, std::hash<int> > >("set+hash", massimo, [](set<int, confronto_interi, std::hash<int> > &s) {
+    s.abilita_prefiltro(0.01);
+  });
+
+  misura_batch<set<int, confronto_interi> >("set", std::min(massimo, 10000UL));
+  misura_batch<set<int, confronto_interi, std::hash<int> > >("set+hash", massimo);
+
+  misura_avvio<int, confronto_interi, std::hash<int> >(massimo);
+  misura_avvio<punto, confronto_punti, hash_punti>(massimo);
+
+  misura_scrittura<int, confronto_interi, std::hash<int> >(massimo);
+  misura_scrittura<std::string, confronto_stringhe, std::hash<std::string> >(massimo);
+  misura_scrittura<punto, confronto_punti, hash_punti>(massimo);
+
+  return 0;
+}
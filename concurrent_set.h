@@ -0,0 +1,178 @@
+#ifndef CONCURRENT_SET_H
+#define CONCURRENT_SET_H
+
+#include <mutex>
+#include <limits>
+#include <cstddef>
+#include "set.h"
+
+/**
+  @brief classe concurrent_set
+
+  Insieme di elementi T utilizzabile da più thread contemporaneamente.
+  Gli elementi sono divisi in shard in base al loro hash; ogni shard è
+  una set<T, Eql, Hash> protetta dal proprio mutex, quindi operazioni su
+  shard diversi procedono in parallelo e i thread si contendono un lock
+  solo quando lavorano sugli stessi shard.
+  add, remove e cerca sono atomiche. size, svuota, istantanea e per_ogni
+  bloccano uno shard alla volta: con scritture concorrenti il risultato
+  può mescolare stati di momenti diversi.
+*/
+template <typename T, typename Eql, typename Hash>
+class concurrent_set
+{
+  typedef set<T, Eql, Hash> set_shard;
+
+  /**
+   * @brief Struttura shard
+   * Porzione dell'insieme con il proprio lock. Il riempimento evita che
+   * i mutex di shard vicini stiano sulla stessa linea di cache.
+   */
+  struct shard
+  {
+    mutable std::mutex lock; ///< lock dello shard
+    set_shard elementi;      ///< elementi dello shard
+    char riempimento[64];    ///< separa gli shard in memoria
+  };
+
+  shard *_shard;           ///< array degli shard
+  std::size_t _n_shard;    ///< numero di shard (potenza di 2)
+  Hash _hash;              ///< funtore di hash per scegliere lo shard
+
+  concurrent_set(const concurrent_set &other);
+  concurrent_set &operator=(const concurrent_set &other);
+
+  /**
+   * @brief Shard a cui appartiene un valore
+   * Usa i bit alti dell'hash, perché quelli bassi scelgono lo slot
+   * nell'indice della set dello shard.
+   * @param v valore
+   * @return lo shard che contiene (o conterrebbe) v
+   */
+  shard &shard_di(const T &v) const
+  {
+    std::size_t h = set_dettagli::mescola(_hash(v));
+    return _shard[(h >> (std::numeric_limits<std::size_t>::digits / 2)) & (_n_shard - 1)];
+  }
+
+public:
+  /**
+   * @brief Costruttore
+   * @param n_shard numero di shard, arrotondato alla potenza di 2 successiva
+   */
+  explicit concurrent_set(std::size_t n_shard = 64) : _shard(nullptr), _n_shard(1)
+  {
+    while (_n_shard < n_shard)
+      _n_shard *= 2;
+    _shard = new shard[_n_shard];
+  }
+
+  /**
+    Distruttore
+  */
+  ~concurrent_set()
+  {
+    delete[] _shard;
+  }
+
+  /**
+   * @brief Aggiunge un elemento se non è già presente
+   * @param v valore da inserire
+   * @return true se l'elemento è stato inserito, false se c'era già
+   */
+  bool add(const T &v)
+  {
+    shard &s = shard_di(v);
+    std::lock_guard<std::mutex> guardia(s.lock);
+    unsigned int prima = s.elementi.size();
+    s.elementi.add(v);
+    return s.elementi.size() != prima;
+  }
+
+  /**
+   * @brief Rimuove un elemento
+   * @param v valore da rimuovere
+   * @return true se l'elemento era presente
+   */
+  bool remove(const T &v)
+  {
+    shard &s = shard_di(v);
+    std::lock_guard<std::mutex> guardia(s.lock);
+    unsigned int prima = s.elementi.size();
+    s.elementi.remove(v);
+    return s.elementi.size() != prima;
+  }
+
+  /**
+   * @brief Cerca un valore
+   * @param valore valore da cercare
+   * @return true se il valore è presente
+   * @return false altrimenti
+   */
+  bool cerca(const T &valore) const
+  {
+    shard &s = shard_di(valore);
+    std::lock_guard<std::mutex> guardia(s.lock);
+    return s.elementi.cerca(valore);
+  }
+
+  /**
+   * @brief Dimensione
+   * Somma le dimensioni degli shard bloccandoli uno alla volta
+   * @return il numero di elementi nell'insieme
+   */
+  unsigned int size() const
+  {
+    unsigned int n = 0;
+    for (std::size_t i = 0; i < _n_shard; ++i)
+    {
+      std::lock_guard<std::mutex> guardia(_shard[i].lock);
+      n += _shard[i].elementi.size();
+    }
+    return n;
+  }
+
+  /**
+   * @brief Svuota l'insieme, uno shard alla volta
+   */
+  void svuota()
+  {
+    for (std::size_t i = 0; i < _n_shard; ++i)
+    {
+      std::lock_guard<std::mutex> guardia(_shard[i].lock);
+      _shard[i].elementi.svuota();
+    }
+  }
+
+  /**
+   * @brief Applica una funzione a ogni elemento
+   * La funzione viene chiamata con il lock dello shard preso, quindi
+   * non deve usare questo insieme.
+   * @param f funzione da chiamare su ogni elemento
+   */
+  template <typename F>
+  void per_ogni(F f) const
+  {
+    for (std::size_t i = 0; i < _n_shard; ++i)
+    {
+      std::lock_guard<std::mutex> guardia(_shard[i].lock);
+      typename set_shard::const_iterator b, e;
+      for (b = _shard[i].elementi.begin(), e = _shard[i].elementi.end(); b != e; ++b)
+        f(*b);
+    }
+  }
+
+  /**
+   * @brief Copia del contenuto in una set
+   * Da usare per iterare o per le operazioni insiemistiche di set
+   * @return una set con gli elementi dell'insieme
+   */
+  set_shard istantanea() const
+  {
+    set_shard s;
+    per_ogni([&s](const T &v) { s.add(v); });
+    return s;
+  }
+};
+
+#endif
@@ -0,0 +1,237 @@
+#ifndef COW_SET_H
+#define COW_SET_H
+
+#include <atomic>
+#include <ostream>
+#include <utility>
+#include "set.h"
+
+/**
+  @brief classe cow_set
+
+  Insieme con copia su scrittura. Le copie di una cow_set condividono
+  la stessa set<T, Eql, Hash> e costano un incremento atomico di un
+  contatore: la set viene copiata (in O(n)) solo alla prima modifica di
+  una copia che la sta ancora condividendo. Conviene quando le copie sono
+  molte più delle modifiche, come per insiemi di configurazione passati
+  per valore.
+  Copie diverse possono essere usate da thread diversi; la stessa
+  cow_set no, come una set. Dalla set condivisa si legge con leggi(),
+  ma operator[] della set aggiorna un indice interno e non va usato su
+  una set condivisa tra thread.
+*/
+template <typename T, typename Eql, typename Hash = void>
+class cow_set
+{
+public:
+  typedef set<T, Eql, Hash> versione;                       ///< tipo della set condivisa
+  typedef typename versione::const_iterator const_iterator; ///< iteratore in lettura
+
+private:
+  /**
+   * @brief Set condivisa con il numero delle cow_set che la usano
+   */
+  struct condivisa
+  {
+    std::atomic<long> riferimenti; ///< cow_set che usano la set
+    versione s;                    ///< set condivisa
+
+    condivisa() : riferimenti(1) {}
+    explicit condivisa(const versione &v) : riferimenti(1), s(v) {}
+    explicit condivisa(versione &&v) : riferimenti(1), s(std::move(v)) {}
+  };
+
+  condivisa *_c; ///< set in uso, mai nullptr
+
+  /**
+   * @brief Lascia una set condivisa, liberandola se era l'ultima cow_set
+   * @param c set da lasciare
+   */
+  static void lascia(condivisa *c)
+  {
+    if (c->riferimenti.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      delete c;
+  }
+
+  /**
+   * @brief Set modificabile da questa sola cow_set
+   * Se la set è condivisa ne fa prima una copia privata. Il caricamento
+   * con acquire rende visibili le letture delle cow_set che l'hanno
+   * lasciata prima di modificarla sul posto.
+   * @return la set privata
+   */
+  versione &privata()
+  {
+    if (_c->riferimenti.load(std::memory_order_acquire) != 1)
+    {
+      condivisa *copia = new condivisa(_c->s);
+      lascia(_c);
+      _c = copia;
+    }
+    return _c->s;
+  }
+
+public:
+  /**
+   * @brief Costruttore di default
+   * @post size() == 0
+   */
+  cow_set() : _c(new condivisa()) {}
+
+  /**
+   * @brief Costruttore da una set
+   * @param s set da copiare
+   */
+  explicit cow_set(const versione &s) : _c(new condivisa(s)) {}
+
+  /**
+   * @brief Costruttore da una set temporanea
+   * @param s set da cui prendere i nodi
+   */
+  explicit cow_set(versione &&s) : _c(new condivisa(std::move(s))) {}
+
+  /**
+   * @brief Copy constructor
+   * Condivide la set di other senza copiarla, in O(1)
+   * @param other cow_set da copiare
+   */
+  cow_set(const cow_set &other) noexcept : _c(other._c)
+  {
+    _c->riferimenti.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Operatore di assegnamento
+   * Lascia la set corrente e condivide quella di other, in O(1)
+   * @param other cow_set da copiare
+   * @return reference a this
+   */
+  cow_set &operator=(const cow_set &other) noexcept
+  {
+    other._c->riferimenti.fetch_add(1, std::memory_order_relaxed);
+    lascia(_c);
+    _c = other._c;
+    return *this;
+  }
+
+  /**
+    Distruttore: lascia la set condivisa
+  */
+  ~cow_set()
+  {
+    lascia(_c);
+  }
+
+  /**
+   * @brief Set in lettura
+   * @return la set, valida fino alla prossima modifica di questa cow_set
+   */
+  const versione &leggi() const
+  {
+    return _c->s;
+  }
+
+  /**
+   * @brief Indica se la set è condivisa con altre cow_set
+   * @return true se la prossima modifica farà una copia
+   */
+  bool condivisa_con_altre() const
+  {
+    return _c->riferimenti.load(std::memory_order_acquire) != 1;
+  }
+
+  bool cerca(const T &valore) const
+  {
+    return _c->s.cerca(valore);
+  }
+
+  unsigned int size() const
+  {
+    return _c->s.size();
+  }
+
+  bool is_empty() const
+  {
+    return _c->s.is_empty();
+  }
+
+  const_iterator begin() const
+  {
+    return _c->s.begin();
+  }
+
+  const_iterator end() const
+  {
+    return _c->s.end();
+  }
+
+  /**
+   * @brief Aggiunge un elemento
+   * Se il valore è già presente la set non viene copiata
+   * @param v valore da inserire
+   */
+  void add(const T &v)
+  {
+    if (!_c->s.cerca(v))
+      privata().add(v);
+  }
+
+  /**
+   * @brief Rimuove un elemento
+   * Se il valore non è presente la set non viene copiata
+   * @param v valore da rimuovere
+   */
+  void remove(const T &v)
+  {
+    if (_c->s.cerca(v))
+      privata().remove(v);
+  }
+
+  /**
+   * @brief Svuota l'insieme
+   * Una set condivisa non viene copiata: questa cow_set ne prende una
+   * nuova vuota.
+   * @post size() == 0
+   */
+  void svuota()
+  {
+    if (condivisa_con_altre())
+    {
+      condivisa *vuota = new condivisa();
+      lascia(_c);
+      _c = vuota;
+    }
+    else
+      _c->s.svuota();
+  }
+
+  /**
+   * @brief Modifica l'insieme con al più una copia
+   * f riceve la set privata di questa cow_set, copiata prima se era
+   * condivisa.
+   * @param f funzione che modifica la set
+   */
+  template <typename F>
+  void modifica(F f)
+  {
+    f(privata());
+  }
+
+  /**
+   * @brief Operatore di uguaglianza
+   * Due cow_set che condividono la stessa set sono uguali in O(1)
+   * @param other cow_set da comparare
+   * @return true se contengono gli stessi elementi
+   */
+  bool operator==(const cow_set &other) const
+  {
+    return _c == other._c || _c->s == other._c->s;
+  }
+
+  friend std::ostream &operator<<(std::ostream &os, const cow_set &s)
+  {
+    return os << s._c->s;
+  }
+};
+
+#endif
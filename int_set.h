@@ -0,0 +1,722 @@
+#ifndef INT_SET_H
+#define INT_SET_H
+
+#include <ostream>
+#include <cassert>
+#include <algorithm>
+#include <iterator>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace int_dettagli
+{
+  /// elementi oltre i quali un contenitore passa da array a bitmap
+  const std::uint32_t soglia_array = 4096;
+
+  /// parole da 64 bit di una bitmap (65536 bit)
+  const std::size_t parole_bitmap = 1024;
+
+  /// numero di bit a 1 in una parola
+  inline unsigned int conta_bit(std::uint64_t x)
+  {
+#if defined(__GNUC__)
+    return static_cast<unsigned int>(__builtin_popcountll(x));
+#else
+    unsigned int n = 0;
+    for (; x != 0; x &= x - 1)
+      ++n;
+    return n;
+#endif
+  }
+
+  /// posizione del bit a 1 più basso di una parola non nulla
+  inline unsigned int primo_bit(std::uint64_t x)
+  {
+#if defined(__GNUC__)
+    return static_cast<unsigned int>(__builtin_ctzll(x));
+#else
+    unsigned int n = 0;
+    for (; (x & 1) == 0; x >>= 1)
+      ++n;
+    return n;
+#endif
+  }
+
+  /**
+   * @brief Codifica di un int come intero senza segno
+   * Inverte il bit di segno, così l'ordine dei codici è quello numerico
+   * degli int.
+   */
+  inline std::uint32_t codifica(int v)
+  {
+    return static_cast<std::uint32_t>(v) ^ 0x80000000u;
+  }
+
+  inline int decodifica(std::uint32_t u)
+  {
+    return static_cast<int>(u ^ 0x80000000u);
+  }
+
+  /**
+    @brief Contenitore dei 16 bit bassi dei valori con la stessa chiave
+
+    Finché ha al più soglia_array elementi è un array ordinato di uint16,
+    altrimenti una bitmap di 65536 bit. La rappresentazione dipende solo
+    dalla cardinalità, quindi due contenitori con gli stessi elementi
+    sono identici anche in memoria.
+  */
+  struct contenitore
+  {
+    std::uint16_t chiave;              ///< 16 bit alti dei valori
+    std::uint32_t cardinalita;         ///< numero di elementi
+    std::vector<std::uint16_t> valori; ///< elementi ordinati (modo array)
+    std::vector<std::uint64_t> parole; ///< bitmap, vuota in modo array
+
+    explicit contenitore(std::uint16_t k) : chiave(k), cardinalita(0) {}
+
+    bool bitmap() const
+    {
+      return !parole.empty();
+    }
+
+    bool cerca(std::uint16_t v) const
+    {
+      if (bitmap())
+        return (parole[v >> 6] >> (v & 63)) & 1;
+      return std::binary_search(valori.begin(), valori.end(), v);
+    }
+
+    /**
+     * @brief Aggiunge un valore
+     * Se il passaggio a bitmap fallisce il contenitore resta com'era
+     * @return true se il valore non c'era
+     */
+    bool add(std::uint16_t v)
+    {
+      if (bitmap())
+      {
+        std::uint64_t bit = std::uint64_t(1) << (v & 63);
+        if (parole[v >> 6] & bit)
+          return false;
+        parole[v >> 6] |= bit;
+        ++cardinalita;
+        return true;
+      }
+      std::vector<std::uint16_t>::iterator i = std::lower_bound(valori.begin(), valori.end(), v);
+      if (i != valori.end() && *i == v)
+        return false;
+      std::ptrdiff_t p = i - valori.begin();
+      valori.insert(i, v);
+      ++cardinalita;
+      try
+      {
+        normalizza();
+      }
+      catch (...)
+      {
+        valori.erase(valori.begin() + p);
+        --cardinalita;
+        throw;
+      }
+      return true;
+    }
+
+    /**
+     * @brief Rimuove un valore
+     * Se il passaggio ad array fallisce il contenitore resta com'era
+     * @return true se il valore c'era
+     */
+    bool remove(std::uint16_t v)
+    {
+      if (!bitmap())
+      {
+        std::vector<std::uint16_t>::iterator i = std::lower_bound(valori.begin(), valori.end(), v);
+        if (i == valori.end() || *i != v)
+          return false;
+        valori.erase(i);
+        --cardinalita;
+        return true;
+      }
+      std::uint64_t bit = std::uint64_t(1) << (v & 63);
+      if (!(parole[v >> 6] & bit))
+        return false;
+      parole[v >> 6] &= ~bit;
+      --cardinalita;
+      try
+      {
+        normalizza();
+      }
+      catch (...)
+      {
+        parole[v >> 6] |= bit;
+        ++cardinalita;
+        throw;
+      }
+      return true;
+    }
+
+    /**
+     * @brief Sceglie la rappresentazione in base alla cardinalità
+     * @pre cardinalita è aggiornata
+     */
+    void normalizza()
+    {
+      if (bitmap() && cardinalita <= soglia_array)
+      {
+        valori.clear();
+        valori.reserve(cardinalita);
+        for (std::size_t w = 0; w < parole_bitmap; ++w)
+          for (std::uint64_t x = parole[w]; x != 0; x &= x - 1)
+            valori.push_back(static_cast<std::uint16_t>(w * 64 + primo_bit(x)));
+        std::vector<std::uint64_t>().swap(parole);
+      }
+      else if (!bitmap() && cardinalita > soglia_array)
+      {
+        parole.assign(parole_bitmap, 0);
+        for (std::size_t i = 0; i < valori.size(); ++i)
+          parole[valori[i] >> 6] |= std::uint64_t(1) << (valori[i] & 63);
+        std::vector<std::uint16_t>().swap(valori);
+      }
+    }
+
+    /// ricalcola la cardinalità di una bitmap dopo un'operazione tra parole
+    void conta()
+    {
+      cardinalita = 0;
+      for (std::size_t w = 0; w < parole_bitmap; ++w)
+        cardinalita += conta_bit(parole[w]);
+    }
+
+    /**
+     * @brief i-esimo valore in ordine crescente
+     * @pre i < cardinalita
+     */
+    std::uint16_t i_esimo(std::uint32_t i) const
+    {
+      if (!bitmap())
+        return valori[i];
+      std::size_t w = 0;
+      for (unsigned int c; (c = conta_bit(parole[w])) <= i; ++w)
+        i -= c;
+      std::uint64_t x = parole[w];
+      for (; i > 0; --i)
+        x &= x - 1;
+      return static_cast<std::uint16_t>(w * 64 + primo_bit(x));
+    }
+
+    /// prima posizione >= p con un elemento (bit in modo bitmap), 65536 se nessuna
+    std::uint32_t prossimo_bit(std::uint32_t p) const
+    {
+      std::size_t w = p >> 6;
+      if (w >= parole_bitmap)
+        return 65536;
+      std::uint64_t x = parole[w] & (~std::uint64_t(0) << (p & 63));
+      while (x == 0)
+      {
+        if (++w == parole_bitmap)
+          return 65536;
+        x = parole[w];
+      }
+      return static_cast<std::uint32_t>(w * 64 + primo_bit(x));
+    }
+
+    bool operator==(const contenitore &other) const
+    {
+      return chiave == other.chiave && cardinalita == other.cardinalita &&
+             valori == other.valori && parole == other.parole;
+    }
+  };
+
+  /**
+   * @brief Unione di due contenitori con la stessa chiave
+   * Tra bitmap è un OR parola per parola.
+   */
+  inline contenitore unisci(const contenitore &a, const contenitore &b)
+  {
+    contenitore r(a.chiave);
+    if (!a.bitmap() && !b.bitmap())
+    {
+      r.valori.reserve(a.valori.size() + b.valori.size());
+      std::set_union(a.valori.begin(), a.valori.end(), b.valori.begin(), b.valori.end(), std::back_inserter(r.valori));
+      r.cardinalita = static_cast<std::uint32_t>(r.valori.size());
+    }
+    else
+    {
+      const contenitore &m = a.bitmap() ? a : b;
+      const contenitore &altro = a.bitmap() ? b : a;
+      r.parole = m.parole;
+      if (altro.bitmap())
+        for (std::size_t w = 0; w < parole_bitmap; ++w)
+          r.parole[w] |= altro.parole[w];
+      else
+        for (std::size_t i = 0; i < altro.valori.size(); ++i)
+          r.parole[altro.valori[i] >> 6] |= std::uint64_t(1) << (altro.valori[i] & 63);
+      r.conta();
+    }
+    r.normalizza();
+    return r;
+  }
+
+  /**
+   * @brief Intersezione di due contenitori con la stessa chiave
+   * Tra bitmap è un AND parola per parola.
+   */
+  inline contenitore interseca(const contenitore &a, const contenitore &b)
+  {
+    contenitore r(a.chiave);
+    if (a.bitmap() && b.bitmap())
+    {
+      r.parole.resize(parole_bitmap);
+      for (std::size_t w = 0; w < parole_bitmap; ++w)
+        r.parole[w] = a.parole[w] & b.parole[w];
+      r.conta();
+    }
+    else if (!a.bitmap() && !b.bitmap())
+    {
+      std::set_intersection(a.valori.begin(), a.valori.end(), b.valori.begin(), b.valori.end(), std::back_inserter(r.valori));
+      r.cardinalita = static_cast<std::uint32_t>(r.valori.size());
+    }
+    else
+    {
+      const contenitore &m = a.bitmap() ? a : b;
+      const contenitore &altro = a.bitmap() ? b : a;
+      for (std::size_t i = 0; i < altro.valori.size(); ++i)
+        if (m.cerca(altro.valori[i]))
+          r.valori.push_back(altro.valori[i]);
+      r.cardinalita = static_cast<std::uint32_t>(r.valori.size());
+    }
+    r.normalizza();
+    return r;
+  }
+}
+
+/**
+  @brief classe int_set
+
+  Insieme di int rappresentato come bitmap compressa in stile Roaring.
+  I valori sono divisi per i 16 bit alti in contenitori ordinati per
+  chiave; ogni contenitore è un array ordinato dei 16 bit bassi finché
+  ha al più 4096 elementi, poi una bitmap da 8 KiB. Per insiemi densi o
+  a gruppi occupa da 2 byte a un bit per elemento invece di un nodo.
+  add, cerca e remove cercano il contenitore per bisezione su un array
+  compatto di chiavi (al più 65536) e poi lavorano in tempo costante
+  sulla bitmap o per bisezione sull'array; unione, intersezione e
+  uguaglianza lavorano contenitore per contenitore, tra bitmap una
+  parola da 64 bit alla volta. Con valori sparsi su tutto l'intervallo
+  degli int ogni valore nuovo crea un contenitore, e add e remove
+  spostano i contenitori successivi: in quel caso conviene set con Hash.
+  L'interfaccia è quella di set, ma gli elementi vengono visitati in
+  ordine crescente e non in ordine di inserimento.
+*/
+class int_set
+{
+  typedef int_dettagli::contenitore contenitore;
+
+  std::vector<contenitore> _contenitori; ///< contenitori ordinati per chiave
+  std::vector<std::uint16_t> _chiavi;    ///< chiavi dei contenitori, per la bisezione
+  unsigned int _size;                    ///< numero di elementi
+
+  /**
+   * @brief Contenitore con una data chiave
+   * @param k chiave
+   * @return posizione del contenitore con chiave k, o di quella dove andrebbe inserito
+   */
+  std::size_t posizione(std::uint16_t k) const
+  {
+    return static_cast<std::size_t>(std::lower_bound(_chiavi.begin(), _chiavi.end(), k) - _chiavi.begin());
+  }
+
+  /**
+   * @brief Aggiunge un contenitore in coda
+   * Usato da unione, intersezione e filter_out, che producono i
+   * contenitori in ordine di chiave; i contenitori vuoti vengono scartati.
+   */
+  void accoda(contenitore &c)
+  {
+    if (c.cardinalita == 0)
+      return;
+    _chiavi.push_back(c.chiave);
+    try
+    {
+      _contenitori.push_back(contenitore(c.chiave));
+    }
+    catch (...)
+    {
+      _chiavi.pop_back();
+      throw;
+    }
+    std::swap(_contenitori.back(), c);
+    _size += _contenitori.back().cardinalita;
+  }
+
+public:
+  /**
+    @brief Iteratore costante
+
+    Visita gli elementi in ordine crescente. Il valore viene ricostruito
+    dalla chiave e dalla posizione nel contenitore, quindi operator*
+    ritorna per valore.
+  */
+  class const_iterator
+  {
+    const std::vector<contenitore> *_c; ///< contenitori dell'insieme
+    std::size_t _i;                     ///< contenitore corrente
+    std::uint32_t _j;                   ///< indice nell'array o bit nella bitmap
+
+    friend class int_set;
+
+    const_iterator(const std::vector<contenitore> *c, std::size_t i) : _c(c), _i(i), _j(0)
+    {
+      entra();
+    }
+
+    /// porta _j sul primo elemento del contenitore corrente
+    void entra()
+    {
+      if (_i < _c->size() && (*_c)[_i].bitmap())
+        _j = (*_c)[_i].prossimo_bit(0);
+    }
+
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef int value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const int *pointer;
+    typedef int reference;
+
+    const_iterator() : _c(nullptr), _i(0), _j(0) {}
+
+    int operator*() const
+    {
+      const contenitore &c = (*_c)[_i];
+      std::uint32_t basso = c.bitmap() ? _j : c.valori[_j];
+      return int_dettagli::decodifica((std::uint32_t(c.chiave) << 16) | basso);
+    }
+
+    const_iterator &operator++()
+    {
+      const contenitore &c = (*_c)[_i];
+      if (c.bitmap())
+        _j = c.prossimo_bit(_j + 1);
+      else
+        ++_j;
+      if ((c.bitmap() && _j == 65536) || (!c.bitmap() && _j == c.valori.size()))
+      {
+        ++_i;
+        _j = 0;
+        entra();
+      }
+      return *this;
+    }
+
+    const_iterator operator++(int)
+    {
+      const_iterator tmp(*this);
+      ++*this;
+      return tmp;
+    }
+
+    bool operator==(const const_iterator &other) const
+    {
+      return _i == other._i && _j == other._j;
+    }
+
+    bool operator!=(const const_iterator &other) const
+    {
+      return !(*this == other);
+    }
+  };
+
+  /**
+   * @brief Costruttore di default
+   * @post size() == 0
+   */
+  int_set() : _size(0) {}
+
+  /**
+   * @brief Costruttore iteratore
+   * Costruttore che crea un int_set riempito con dati presi da una
+   * sequenza identificata da un iteratore di inizio e uno di fine
+   * @param b iteratore di inizio
+   * @param e iteratore di fine
+   */
+  template <typename Q>
+  int_set(Q b, Q e) : _size(0)
+  {
+    insert(b, e);
+  }
+
+  /**
+   * @brief Inserimento di una sequenza
+   * Aggiunge gli elementi della sequenza scartando i duplicati
+   * @param b iteratore di inizio
+   * @param e iteratore di fine
+   */
+  template <typename Q>
+  void insert(Q b, Q e)
+  {
+    for (; b != e; ++b)
+      add(static_cast<int>(*b));
+  }
+
+  /**
+   * @brief Svuota l'insieme
+   * @post size() == 0
+   */
+  void svuota()
+  {
+    _contenitori.clear();
+    _chiavi.clear();
+    _size = 0;
+  }
+
+  /**
+   * @brief Funzione per vedere se l'insieme è vuoto
+   * @return true se l'insieme è vuoto
+   * @return false altrimenti
+   */
+  bool is_empty() const
+  {
+    return _size == 0;
+  }
+
+  /**
+   * @brief Dimensione
+   * @return il numero di elementi nell'insieme
+   */
+  unsigned int size() const
+  {
+    return _size;
+  }
+
+  /**
+   * @brief Aggiunge un elemento se non è già presente
+   * @param v valore da inserire
+   */
+  void add(int v)
+  {
+    std::uint32_t u = int_dettagli::codifica(v);
+    std::uint16_t k = static_cast<std::uint16_t>(u >> 16);
+    std::size_t i = posizione(k);
+    bool nuovo = i == _contenitori.size() || _chiavi[i] != k;
+    if (nuovo)
+    {
+      _contenitori.insert(_contenitori.begin() + i, contenitore(k));
+      try
+      {
+        _chiavi.insert(_chiavi.begin() + i, k);
+      }
+      catch (...)
+      {
+        _contenitori.erase(_contenitori.begin() + i);
+        throw;
+      }
+    }
+    try
+    {
+      if (_contenitori[i].add(static_cast<std::uint16_t>(u)))
+        ++_size;
+    }
+    catch (...)
+    {
+      if (nuovo)
+      {
+        _contenitori.erase(_contenitori.begin() + i);
+        _chiavi.erase(_chiavi.begin() + i);
+      }
+      throw;
+    }
+  }
+
+  /**
+   * @brief Rimuovi
+   * Rimuove l'elemento uguale a v, se presente
+   * @param v valore da rimuovere
+   */
+  void remove(int v)
+  {
+    std::uint32_t u = int_dettagli::codifica(v);
+    std::uint16_t k = static_cast<std::uint16_t>(u >> 16);
+    std::size_t i = posizione(k);
+    if (i == _contenitori.size() || _chiavi[i] != k)
+      return;
+    if (_contenitori[i].remove(static_cast<std::uint16_t>(u)))
+    {
+      --_size;
+      if (_contenitori[i].cardinalita == 0)
+      {
+        _contenitori.erase(_contenitori.begin() + i);
+        _chiavi.erase(_chiavi.begin() + i);
+      }
+    }
+  }
+
+  /**
+   * @brief Cerca un valore
+   * @param valore valore da cercare
+   * @return true se il valore è presente
+   * @return false altrimenti
+   */
+  bool cerca(int valore) const
+  {
+    std::uint32_t u = int_dettagli::codifica(valore);
+    std::uint16_t k = static_cast<std::uint16_t>(u >> 16);
+    std::size_t i = posizione(k);
+    return i != _contenitori.size() && _chiavi[i] == k &&
+           _contenitori[i].cerca(static_cast<std::uint16_t>(u));
+  }
+
+  // Ritorna l'iteratore al più piccolo elemento
+  const_iterator begin() const
+  {
+    return const_iterator(&_contenitori, 0);
+  }
+
+  // Ritorna l'iteratore alla fine della sequenza
+  const_iterator end() const
+  {
+    return const_iterator(&_contenitori, _contenitori.size());
+  }
+
+  /**
+   * @brief Operatore[]
+   * Accesso in sola lettura all'i-esimo elemento in ordine crescente.
+   * Salta i contenitori precedenti usando la loro cardinalità.
+   * @param i posizione dell'elemento
+   * @return elemento in posizione i
+   */
+  int operator[](int i) const
+  {
+    assert(i >= 0 && static_cast<unsigned int>(i) < size());
+    std::uint32_t resto = static_cast<std::uint32_t>(i);
+    std::size_t c = 0;
+    while (_contenitori[c].cardinalita <= resto)
+      resto -= _contenitori[c++].cardinalita;
+    return int_dettagli::decodifica((std::uint32_t(_contenitori[c].chiave) << 16) | _contenitori[c].i_esimo(resto));
+  }
+
+  /**
+   * @brief Operatore di uguaglianza
+   * La rappresentazione dipende solo dal contenuto, quindi confronta i
+   * contenitori uno per uno, parola per parola tra bitmap.
+   * @param other insieme da comparare
+   * @return true se i due insiemi contengono gli stessi elementi
+   * @return false altrimenti
+   */
+  bool operator==(const int_set &other) const
+  {
+    return _size == other._size && _contenitori == other._contenitori;
+  }
+
+  /**
+   * @brief Funzione di stream
+   * @param os stream di output
+   * @param s insieme da spedire sullo stream
+   * @return lo stream di output
+   */
+  friend std::ostream &operator<<(std::ostream &os, const int_set &s)
+  {
+    for (const_iterator i = s.begin(); i != s.end(); ++i)
+      os << *i << " ";
+    return os;
+  }
+
+  /**
+   * @brief filter_out
+   * Funzione GLOBALE che ritorna un insieme con gli elementi di S che
+   * soddisfano il predicato. I contenitori vengono costruiti in ordine
+   * e accodati senza ricerche.
+   * @param S insieme su cui applicare il predicato
+   * @param predicato predicato da applicare
+   * @return insieme con gli elementi che verificano il predicato
+   */
+  template <typename P>
+  friend int_set filter_out(const int_set &S, P predicato)
+  {
+    int_set s1;
+    for (std::size_t c = 0; c < S._contenitori.size(); ++c)
+    {
+      const contenitore &da = S._contenitori[c];
+      contenitore nuovo(da.chiave);
+      std::uint32_t alto = std::uint32_t(da.chiave) << 16;
+      if (da.bitmap())
+      {
+        nuovo.parole.assign(int_dettagli::parole_bitmap, 0);
+        for (std::uint32_t j = da.prossimo_bit(0); j < 65536; j = da.prossimo_bit(j + 1))
+          if (predicato(int_dettagli::decodifica(alto | j)))
+            nuovo.parole[j >> 6] |= std::uint64_t(1) << (j & 63);
+        nuovo.conta();
+      }
+      else
+      {
+        for (std::size_t j = 0; j < da.valori.size(); ++j)
+          if (predicato(int_dettagli::decodifica(alto | da.valori[j])))
+            nuovo.valori.push_back(da.valori[j]);
+        nuovo.cardinalita = static_cast<std::uint32_t>(nuovo.valori.size());
+      }
+      nuovo.normalizza();
+      s1.accoda(nuovo);
+    }
+    return s1;
+  }
+
+  /**
+   * @brief operatore di unione
+   * Fonde le due liste di contenitori; i contenitori con la stessa
+   * chiave vengono uniti con un OR tra bitmap o una fusione tra array.
+   * @param s1 primo insieme
+   * @param s2 secondo insieme
+   * @return insieme con gli elementi di entrambi
+   */
+  friend int_set operator+(const int_set &s1, const int_set &s2)
+  {
+    int_set s3;
+    s3._contenitori.reserve(s1._contenitori.size() + s2._contenitori.size());
+    s3._chiavi.reserve(s1._contenitori.size() + s2._contenitori.size());
+    std::size_t i = 0, j = 0;
+    while (i < s1._contenitori.size() || j < s2._contenitori.size())
+    {
+      contenitore c(0);
+      if (j == s2._contenitori.size() || (i < s1._contenitori.size() && s1._contenitori[i].chiave < s2._contenitori[j].chiave))
+        c = s1._contenitori[i++];
+      else if (i == s1._contenitori.size() || s2._contenitori[j].chiave < s1._contenitori[i].chiave)
+        c = s2._contenitori[j++];
+      else
+        c = int_dettagli::unisci(s1._contenitori[i++], s2._contenitori[j++]);
+      s3.accoda(c);
+    }
+    return s3;
+  }
+
+  /**
+   * @brief operatore di intersezione
+   * Solo le chiavi comuni possono dare elementi; i loro contenitori
+   * vengono intersecati con un AND tra bitmap o una fusione tra array.
+   * @param s1 primo insieme
+   * @param s2 secondo insieme
+   * @return insieme con gli elementi comuni
+   */
+  friend int_set operator-(const int_set &s1, const int_set &s2)
+  {
+    int_set s3;
+    s3._contenitori.reserve(std::min(s1._contenitori.size(), s2._contenitori.size()));
+    s3._chiavi.reserve(std::min(s1._contenitori.size(), s2._contenitori.size()));
+    std::size_t i = 0, j = 0;
+    while (i < s1._contenitori.size() && j < s2._contenitori.size())
+    {
+      if (s1._contenitori[i].chiave < s2._contenitori[j].chiave)
+        ++i;
+      else if (s2._contenitori[j].chiave < s1._contenitori[i].chiave)
+        ++j;
+      else
+      {
+        contenitore c = int_dettagli::interseca(s1._contenitori[i++], s2._contenitori[j++]);
+        s3.accoda(c);
+      }
+    }
+    return s3;
+  }
+};
+
+#endif
@@ -0,0 +1,228 @@
+#ifndef INTERNED_STRING_H
+#define INTERNED_STRING_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "set.h"
+
+namespace set_dettagli
+{
+  /**
+   * @brief Stringa copiata nell'arena di una tabella_stringhe
+   * I caratteri seguono l'intestazione, terminati da '\0'.
+   */
+  struct stringa_in_tabella
+  {
+    std::size_t hash;      ///< hash del contenuto
+    std::size_t lunghezza; ///< numero di caratteri
+    char testo[1];         ///< primo carattere
+  };
+
+  /**
+   * @brief Hash FNV-1a di una sequenza di byte
+   * @param s inizio dei byte
+   * @param n numero di byte
+   * @return hash del contenuto, uguale tra esecuzioni diverse
+   */
+  inline std::size_t hash_byte(const char *s, std::size_t n)
+  {
+    std::uint64_t h = 0xcbf29ce484222325ULL;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      h ^= static_cast<unsigned char>(s[i]);
+      h *= 0x100000001b3ULL;
+    }
+    return static_cast<std::size_t>(h);
+  }
+}
+
+/**
+  @brief classe stringa_internata
+
+  Riferimento a una stringa conservata una sola volta in una
+  tabella_stringhe. Copiarla costa un puntatore, e due stringhe internate
+  dalla stessa tabella sono uguali se e solo se sono lo stesso
+  puntatore, quindi uguaglianza e hash (calcolato una volta
+  all'internamento) sono O(1) qualunque sia la lunghezza. Resta valida
+  finché esiste la tabella. La stringa vuota è la stringa_internata
+  costruita di default.
+*/
+class stringa_internata
+{
+  const set_dettagli::stringa_in_tabella *_s; ///< stringa nella tabella, nullptr se vuota
+
+  friend class tabella_stringhe;
+
+  explicit stringa_internata(const set_dettagli::stringa_in_tabella *s) : _s(s) {}
+
+public:
+  /**
+   * @brief Costruttore di default
+   * @post size() == 0
+   */
+  stringa_internata() : _s(nullptr) {}
+
+  /// caratteri della stringa, terminati da '\0'
+  const char *c_str() const
+  {
+    return _s == nullptr ? "" : _s->testo;
+  }
+
+  std::size_t size() const
+  {
+    return _s == nullptr ? 0 : _s->lunghezza;
+  }
+
+  /// hash del contenuto calcolato all'internamento
+  std::size_t hash() const
+  {
+    return _s == nullptr ? set_dettagli::hash_byte("", 0) : _s->hash;
+  }
+
+  /// copia della stringa
+  std::string str() const
+  {
+    return std::string(c_str(), size());
+  }
+
+  bool operator==(const stringa_internata &other) const
+  {
+    return _s == other._s;
+  }
+
+  bool operator!=(const stringa_internata &other) const
+  {
+    return _s != other._s;
+  }
+
+  friend std::ostream &operator<<(std::ostream &os, const stringa_internata &s)
+  {
+    return os.write(s.c_str(), static_cast<std::streamsize>(s.size()));
+  }
+};
+
+/**
+ * @brief Funtore di uguaglianza tra stringhe internate dalla stessa tabella
+ */
+struct confronto_internate
+{
+  bool operator()(const stringa_internata &a, const stringa_internata &b) const
+  {
+    return a == b;
+  }
+};
+
+/**
+ * @brief Funtore di hash per le stringhe internate
+ * Restituisce l'hash memorizzato, senza leggere i caratteri
+ */
+struct hash_internate
+{
+  std::size_t operator()(const stringa_internata &s) const
+  {
+    return s.hash();
+  }
+};
+
+/**
+  @brief classe tabella_stringhe
+
+  Conserva una sola copia di ogni stringa, in un'arena, e la restituisce
+  come stringa_internata. Più set di stringhe_internate che contengono
+  le stesse stringhe condividono così la stessa memoria, e nelle set i
+  confronti diventano confronti tra puntatori. Le stringhe non vengono
+  mai tolte: la memoria torna tutta insieme alla distruzione della
+  tabella, che deve sopravvivere alle stringhe_internate che ha dato.
+  interna può essere chiamata da più thread.
+*/
+class tabella_stringhe
+{
+  typedef set_dettagli::stringa_in_tabella voce;
+
+  arena _memoria;                 ///< memoria delle stringhe
+  std::vector<const voce *> _slot; ///< tabella ad indirizzamento aperto (potenza di 2)
+  std::size_t _usati;             ///< stringhe conservate
+  mutable std::mutex _lock;       ///< serializza interna
+
+  tabella_stringhe(const tabella_stringhe &other);
+  tabella_stringhe &operator=(const tabella_stringhe &other);
+
+  // Raddoppia la tabella degli slot, reinserendo le stringhe presenti
+  void ridimensiona()
+  {
+    std::vector<const voce *> nuovi(_slot.empty() ? 64 : 2 * _slot.size(), nullptr);
+    std::size_t maschera = nuovi.size() - 1;
+    for (std::size_t i = 0; i < _slot.size(); ++i)
+      if (_slot[i] != nullptr)
+      {
+        std::size_t j = set_dettagli::mescola(_slot[i]->hash) & maschera;
+        while (nuovi[j] != nullptr)
+          j = (j + 1) & maschera;
+        nuovi[j] = _slot[i];
+      }
+    _slot.swap(nuovi);
+  }
+
+public:
+  /**
+   * @brief Costruttore
+   * @param dim_blocco byte dei blocchi dell'arena
+   */
+  explicit tabella_stringhe(std::size_t dim_blocco = 64 * 1024) : _memoria(dim_blocco), _usati(0) {}
+
+  /**
+   * @brief Interna una stringa
+   * @param s caratteri della stringa
+   * @param n numero di caratteri
+   * @return la stringa_internata, la stessa per contenuti uguali
+   */
+  stringa_internata interna(const char *s, std::size_t n)
+  {
+    if (n == 0)
+      return stringa_internata();
+    std::size_t h = set_dettagli::hash_byte(s, n);
+    std::lock_guard<std::mutex> guardia(_lock);
+    if ((_usati + 1) * 4 > _slot.size() * 3)
+      ridimensiona();
+    std::size_t maschera = _slot.size() - 1;
+    std::size_t j = set_dettagli::mescola(h) & maschera;
+    for (; _slot[j] != nullptr; j = (j + 1) & maschera)
+      if (_slot[j]->hash == h && _slot[j]->lunghezza == n && std::memcmp(_slot[j]->testo, s, n) == 0)
+        return stringa_internata(_slot[j]);
+    voce *v = static_cast<voce *>(_memoria.prendi(offsetof(voce, testo) + n + 1, alignof(voce)));
+    v->hash = h;
+    v->lunghezza = n;
+    std::memcpy(v->testo, s, n);
+    v->testo[n] = '\0';
+    _slot[j] = v;
+    _usati++;
+    return stringa_internata(v);
+  }
+
+  stringa_internata interna(const std::string &s)
+  {
+    return interna(s.data(), s.size());
+  }
+
+  stringa_internata interna(const char *s)
+  {
+    return interna(s, std::strlen(s));
+  }
+
+  /**
+   * @brief Numero di stringhe conservate
+   * @return il numero di stringhe distinte non vuote internate
+   */
+  std::size_t size() const
+  {
+    std::lock_guard<std::mutex> guardia(_lock);
+    return _usati;
+  }
+};
+
+#endif
@@ -1,580 +1,2025 @@
-#include <iostream>
-#include <ostream>
-#include <cassert>
-#include <algorithm>
-#include "set.h"
-
-/**
- * @brief Funtore di uguaglianza tra tipi interi
- * 
- */
-struct confronto_interi
-{
-  bool operator()(int a, int b) const
-  {
-    return a == b;
-  }
-};
-/**
- * @brief Funtore di uguaglianza tra tipi stringhe
- * 
- */
-struct confronto_stringhe
-{
-  bool operator()(const std::string &a, const std::string &b) const
-  {
-    return (a == b);
-  }
-};
-/**
- * @brief Struttura del punto
- * Punto a due dimensioni
- */
-struct punto
-{
-  int x; ///< coordinata x del punto
-  int y; ///< coordinata y del punto
-
-  /**
-   * @brief Costruttore di default
-   * @post x == 0
-   * @post y == 0
-   */
-  punto() : x(0), y(0) {}
-  /**
-   * @brief Costruttore Secondario
-   * 
-   * @param xx valore da copiare nella coordinata x
-   * @param yy valore da copaire nella coordinata y
-   * @post x == xx
-   * @post y == yy
-   */
-  punto(int xx, int yy) : x(xx), y(yy) {}
-  /**
-   * @brief Copy constructor
-   * 
-   * @param other punto da copiare
-   * @post x = other.x
-   * @post y = other.y
-   */
-  punto(const punto &other) : x(other.x), y(other.y) {}
-
-  /**
-   * @brief Operatore di assegnamento
-   * 
-   * @param other punto da copiare
-   * @return ritorna un punto con coordinate preso dal punto passato alla funzione
-   */
-  punto &operator=(const punto &other)
-  {
-    x = other.x;
-    y = other.y;
-    return *this;
-  }
-  /**
-   * @brief Operatore di uguaglianza tra due punti
-   * Verifica che entrambe le coordinate dei due punti siano uguali
-   * @param other punto da confrontare
-   * @return true se i punti sono uguali
-   * @return false se i punti sono diversi
-   */
-  bool operator==(const punto &other)const{
-    return x == other.x && y == other.y;
-  }
-  /**
-   * @brief Operatore di disuguaglianza tra due punti
-   * Verifica che entrambe le coordinate dei due punti siano diverse
-   * @param other punto da confrontare
-   * @return true se i punti sono diversi
-   * @return false se i punti sono uguali
-   */
-  bool operator!=(const punto &other)const{
-    return (x != other.x | y != other.y);
-  }
-  /**
-      Distruttore. 
-    */
-  ~punto() {}
-
-  /**
- * @brief Funzione di stream
- *  Ridefinizione dell'operatore di stream per un punto.
-    Necessario per l'operatore di stream della classe set.
- * 
- * @param os os stream di output
- * @param p punto da spedire sullo stream
- * @return lo stream di output  
- */
-friend std::ostream &operator<<(std::ostream &os, const punto &p)
-{
-  os << "(" << p.x << "," << p.y << ")";
-  return os;
-}
-};
-
-/**
- * @brief Funtore di uguaglianza tra tipi punto
- * 
- */
-struct confronto_punti
-{
-  bool operator()(const punto &p1, const punto &p2) const
-  {
-    return (p1.x == p2.x && p1.y == p2.y);
-  }
-};
-/**
- * @brief Funtore predicato interi
- * Ritorna true se il valore intero passato è pari
- */
-struct int_pari
-{
-  bool operator()(int i) const
-  {
-    return (i % 2 == 0);
-  }
-};
-/**
- * @brief Funtore predicato interi
- * Ritorna true se il valore intero passato è dispari
- */
-struct int_dispari
-{
-  bool operator()(int i) const
-  {
-    return (i % 2 != 0);
-  }
-};
-/**
- * @brief Funtore predicato stringhe
- * Ritorna true se la lunghezza della stringa passata è pari
- */
-struct string_pari
-{
-  bool operator()(std::string i) const
-  {
-    return (i.size() % 2 == 0);
-  }
-};
-/**
- * @brief Funtore predicato stringhe
- * Ritorna true se la lunghezza della stringa passata è dispari
- */
-struct string_dispari
-{
-  bool operator()(std::string i) const
-  {
-    return (i.size() % 2 != 0);
-  }
-};
-/**
- * @brief Funtore predicato punti
- * Ritorna true se entrambe le coordinate del punto sono pari
- */
-struct punto_pari
-{
-  bool operator()(punto i) const
-  {
-    return (i.x % 2 == 0 && i.y % 2 == 0);
-  }
-};
-/**
- * @brief Funtore predicato punti
- * Ritorna true se entrambe le coordinate del punto sono dispari
- */
-struct punto_dispari
-{
-  bool operator()(punto i) const
-  {
-    return (i.x % 2 != 0 && i.y % 2 != 0);
-  }
-};
-
-/** 
- * Nel seguente metodo vengono effettuati tutti i test su un set di interi
- */
-void test_int()
-{
-
-  set<int, confronto_interi> lista1;
-  set<int, confronto_interi> lista2(lista1);
-  set<int, confronto_interi> lista4;
-  assert(lista1.size() == 0);
-  assert(lista2.size() == 0);
-  for (int i = 0; i < 10; i++)
-  {
-    lista1.add(i);
-  }
-  assert(lista1.size() == 10);
-  set<int, confronto_interi> lista3(lista1);
-  assert(lista3.size() == 10);
-  lista4 = lista1;
-  assert(lista4.size() == 10);
-  assert(lista1 == lista3);
-  lista1.svuota();
-  assert(lista1.size() == 0);
-  lista4.remove(0);
-  std::cout << lista4 << std::endl;
-  lista4.remove(9);
-  std::cout << lista4 << std::endl;
-  lista4.remove(4);
-  std::cout << lista4 << std::endl;
-  assert(lista4.size() == 7);
-  lista4.add(1);
-  int vett[4] = {1, 2, 3, 4};
-  set<int, confronto_interi> lista5(vett, vett + 4);
-  std::cout << lista5 << std::endl;
-  assert(lista4.cerca(5));
-  assert(lista4.cerca(1));
-  assert(lista4.cerca(8));
-  assert(!lista4.cerca(10));
-  set<int, confronto_interi> lista6;
-  set<int, confronto_interi> lista7;
-  lista6.add(1);
-  lista6.add(4);
-  lista7.add(1);
-  lista7.add(4);
-  std::cout << "lista6" << std::endl;
-  std::cout << lista6 << std::endl;
-  std::cout << "lista7" << std::endl;
-  std::cout << lista7 << std::endl;
-  assert(!(lista6 == lista1));
-  assert(!(lista1 == lista4));
-  assert(lista1 == lista2);
-  assert(lista6 == lista7);
-  assert(lista4[2]);
-  assert(lista4[0]);
-  assert(lista4[6]);
-  std::cout << lista4[2] << std::endl;
-
-  int v[5] = {1, 5, 9, 3, 0};
-  set<int, confronto_interi> lista8(v, v + 5);
-  set<int, confronto_interi>::const_iterator i, b, e;
-  assert(b == e);
-  i = lista8.begin();
-  set<int, confronto_interi>::const_iterator ii(i);
-  assert(i == ii);
-  assert((*i) == (*ii));
-  i++;
-  ii++;
-  assert(i == ii);
-  assert((*i) == (*ii));
-  ++i;
-  ii++;
-  assert(i == ii);
-  assert((*i) == (*ii));
-
-  assert(*i == 9 && *ii == 9);
-  i++;
-  assert(i != ii);
-  assert((*i) != (*ii));
-  const int *p = &(*i);
-  assert(*p == 3);
-  i = ii;
-  assert(i == ii);
-  set<int, confronto_interi> lista9;
-  set<int, confronto_interi> lista10;
-  set<int, confronto_interi> lista11;
-  lista9.add(1);
-  lista9.add(4);
-  lista9.add(7);
-  lista10.add(1);
-  lista10.add(4);
-  lista10.add(8);
-  std::cout << "lista9" << std::endl;
-  std::cout << lista9 << std::endl;
-  std::cout << "lista10" << std::endl;
-  std::cout << lista10 << std::endl;
-  lista11 = lista9 + lista10;
-  std::cout << lista11 << std::endl;
-  lista11 = lista9 - lista10;
-  std::cout << lista11 << std::endl;
-  set<int, confronto_interi> lista12;
-  set<int, confronto_interi> lista13;
-  lista13.add(2);
-  lista13.add(4);
-  lista13.add(9);
-  int_pari ip;
-  int_dispari id;
-  lista12 = filter_out(lista13, ip);
-  std::cout << "lista13" << std::endl;
-  std::cout << lista12 << std::endl;
-  lista12 = filter_out(lista13, id);
-  std::cout << "lista13" << std::endl;
-  std::cout << lista12 << std::endl;
-}
-/** 
- * Nel seguente metodo vengono effettuati tutti i test su un set di stringhe
- */
-void test_string()
-{
-
-  set<std::string, confronto_stringhe> lista1;
-  set<std::string, confronto_stringhe> lista2(lista1);
-  set<std::string, confronto_stringhe> lista4;
-  assert(lista1.size() == 0);
-  assert(lista2.size() == 0);
-  lista1.add("pippo");
-  lista1.add("pluto");
-  lista1.add("paperino");
-  lista1.add("cip");
-  lista1.add("cip");
-  //std::cout<<lista1<<std::endl;
-  assert(lista1.size() == 4);
-  set<std::string, confronto_stringhe> lista3(lista1);
-  assert(lista3.size() == 4);
-  lista4 = lista1;
-  assert(lista4.size() == 4);
-  assert(lista1 == lista3);
-  lista1.svuota();
-  assert(lista1.size() == 0);
-  lista4.remove("pippo");
-  std::cout << lista4 << std::endl;
-  lista4.remove("cip");
-  std::cout << lista4 << std::endl;
-  lista4.remove("pluto");
-  std::cout << lista4 << std::endl;
-  assert(lista4.size() == 1);
-  lista4.add("pippo");
-  lista4.add("pluto");
-  std::string vett[4] = {"pippo", "pluto", "paperino", "cip"};
-  set<std::string, confronto_stringhe> lista5(vett, vett + 4);
-  std::cout << lista5 << std::endl;
-  assert(lista4.cerca("pluto"));
-  assert(lista4.cerca("paperino"));
-  assert(lista4.cerca("pippo"));
-  assert(!lista4.cerca("cip"));
-  std::string s = lista4[2];
-  set<std::string, confronto_stringhe> lista6;
-  set<std::string, confronto_stringhe> lista7;
-  lista6.add("pippo");
-  lista6.add("pluto");
-  lista7.add("pippo");
-  lista7.add("pluto");
-  std::cout << "lista6" << std::endl;
-  std::cout << lista6 << std::endl;
-  std::cout << "lista7" << std::endl;
-  std::cout << lista7 << std::endl;
-  assert(!(lista6 == lista1));
-  assert(!(lista1 == lista4));
-  assert(lista1 == lista2);
-  assert(lista6 == lista7);
-  std::cout << lista4[1] << std::endl;
-  std::cout << lista4[0] << std::endl;
-  std::cout << lista4[2] << std::endl;
-
-  std::string v[4] = {"pippo", "pluto", "paperino", "cip"};
-  set<std::string, confronto_stringhe> lista8(v, v + 4);
-  set<std::string, confronto_stringhe>::const_iterator i, b, e;
-  assert(b == e);
-  i = lista8.begin();
-  set<std::string, confronto_stringhe>::const_iterator ii(i);
-  assert(i == ii);
-  assert((*i) == (*ii));
-  i++;
-  ii++;
-  assert(i == ii);
-  assert((*i) == (*ii));
-  ++i;
-  ii++;
-  assert(i == ii);
-  assert((*i) == (*ii));
-
-  assert((*i) == "paperino" && *ii == "paperino");
-  i++;
-  assert(i != ii);
-  assert((*i) != (*ii));
-  const std::string *p = &(*i);
-  assert(*p == "cip");
-  i = ii;
-  assert(i == ii);
-  set<std::string, confronto_stringhe> lista9;
-  set<std::string, confronto_stringhe> lista10;
-  set<std::string, confronto_stringhe> lista11;
-  lista9.add("pippo");
-  lista9.add("pluto");
-  lista9.add("paperino");
-  lista10.add("pippo");
-  lista10.add("pluto");
-  lista10.add("cip");
-  std::cout << "lista9" << std::endl;
-  std::cout << lista9 << std::endl;
-  std::cout << "lista10" << std::endl;
-  std::cout << lista10 << std::endl;
-  lista11 = lista9 + lista10;
-  std::cout << lista11 << std::endl;
-  lista11 = lista9 - lista10;
-  std::cout << lista11 << std::endl;
-  set<std::string, confronto_stringhe> lista12;
-  set<std::string, confronto_stringhe> lista13;
-  lista13.add("qwer");
-  lista13.add("pippo");
-  lista13.add("pluto");
-  string_pari sp;
-  string_dispari sd;
-  lista12 = filter_out(lista13, sp);
-  std::cout << "lista13" << std::endl;
-  std::cout << lista12 << std::endl;
-  lista12 = filter_out(lista13, sd);
-  std::cout << "lista13" << std::endl;
-  std::cout << lista12 << std::endl;
-}
-/** 
- * Nel seguente metodo vengono effettuati tutti i test su un set di punti
- */
-void test_custom()
-{
-  set<punto, confronto_punti> lista1;
-  set<punto, confronto_punti> lista2(lista1);
-  set<punto, confronto_punti> lista4;
-  assert(lista1.size() == 0);
-  assert(lista2.size() == 0);
-  punto punto1(1, 2);
-  punto punto2(3, 4);
-  punto punto3(5, 6);
-  punto punto4(7, 8);
-  punto punto5(1, 2);
-  lista1.add(punto1);
-  lista1.add(punto2);
-  lista1.add(punto3);
-  lista1.add(punto4);
-  lista1.add(punto5);
-  assert(lista1.size() == 4);
-  set<punto, confronto_punti> lista3(lista1);
-  assert(lista3.size() == 4);
-  lista4 = lista1;
-  assert(lista4.size() == 4);
-  assert(lista1 == lista3);
-  lista1.svuota();
-  assert(lista1.size() == 0);
-  lista4.remove(punto1);
-  std::cout << lista4 << std::endl;
-  lista4.remove(punto4);
-  std::cout << lista4 << std::endl;
-  lista4.remove(punto3);
-  std::cout << lista4 << std::endl;
-  assert(lista4.size() == 1);
-  lista4.add(punto1);
-  lista4.add(punto3);
-  punto vett[4] = {punto1, punto2, punto3, punto4};
-  set<punto, confronto_punti> lista5(vett, vett + 4);
-  std::cout << lista5 << std::endl;
-  assert(lista4.cerca(punto1));
-  assert(lista4.cerca(punto2));
-  assert(lista4.cerca(punto3));
-  assert(!lista4.cerca(punto4));
-  punto s = lista4[2];
-  set<punto, confronto_punti> lista6;
-  set<punto, confronto_punti> lista7;
-  lista6.add(punto1);
-  lista6.add(punto2);
-  lista7.add(punto1);
-  lista7.add(punto2);
-  std::cout << "lista6" << std::endl;
-  std::cout << lista6 << std::endl;
-  std::cout << "lista7" << std::endl;
-  std::cout << lista7 << std::endl;
-  assert(!(lista6 == lista1));
-  assert(!(lista1 == lista4));
-  assert(lista1 == lista2);
-  assert(lista6 == lista7);
-  std::cout << lista4[1] << std::endl;
-  std::cout << lista4[0] << std::endl;
-  std::cout << lista4[2] << std::endl;
-
-  punto setPunti[4] = {punto(-1, 6), punto(1, 1), punto(1, -4), punto(1, -3)};
-  set<punto, confronto_punti> punto20(setPunti, setPunti + 4);
-  set<punto, confronto_punti>::const_iterator i, b, e;
-  assert(b == e);
-  i = punto20.begin();
-  set<punto, confronto_punti>::const_iterator ii(i);
-  assert(i == ii);
-  assert((*i) == (*ii));
-  i++;
-  ii++;
-  assert(i == ii);
-  assert((*i) == (*ii));
-  ++i;
-  ii++;
-  assert(i == ii);
-  assert((*i) == (*ii));
-  assert((*i) == punto(1,-4) && *ii == punto(1,-4));
-  i++;
-  assert(i != ii);
-  assert((*i) != (*ii));
-  const punto *p = &(*i);
-  assert(*p == punto(1, -3));
-  i = ii;
-  assert(i == ii);
-  
-  /*punto v[5] = {punto(-1, -5), punto(0, 0), punto(1, -4), punto(-4, -3), punto(10, 3)};
-  set<punto, confronto_punti> punto8(v, v + 5);
-  set<punto, confronto_punti>::const_iterator i, b, e;
-  assert(b == e);
-  i = punto8.begin();
-  set<punto, confronto_punti>::const_iterator ii(i);
-  assert(i == ii);
-  assert((*i) == (*ii));
-  i++;
-  ii++;
-  assert(i == ii);
-  assert((*i) == (*ii));
-  ++i;
-  ii++;
-  assert(i == ii);
-  assert((*i) == (*ii));
-
-  assert(*i == 9 && *ii == 9);
-  i++;
-  assert(i != ii);
-  assert((*i) != (*ii));
-  const int *p = &(*i);
-  assert(*p == 3);
-  i = ii;
-  assert(i == ii);*/
-
-  set<punto, confronto_punti> lista9;
-  set<punto, confronto_punti> lista10;
-  set<punto, confronto_punti> lista11;
-  lista9.add(punto1);
-  lista9.add(punto2);
-  lista9.add(punto3);
-  lista10.add(punto1);
-  lista10.add(punto2);
-  lista10.add(punto4);
-  std::cout << "lista9" << std::endl;
-  std::cout << lista9 << std::endl;
-  std::cout << "lista10" << std::endl;
-  std::cout << lista10 << std::endl;
-  lista11 = lista9 + lista10;
-  std::cout << "+" << lista11 << std::endl;
-  lista11 = lista9 - lista10;
-  std::cout << "-" << lista11 << std::endl;
-  set<punto, confronto_punti> lista12;
-  set<punto, confronto_punti> lista13;
-  punto punto9(2, 4);
-  punto punto6(2, 6);
-  punto punto7(1, 3);
-  punto punto8(3, 7);
-  lista13.add(punto9);
-  lista13.add(punto6);
-  lista13.add(punto7);
-  lista13.add(punto8);
-  punto_pari pp;
-  punto_dispari pd;
-  lista12 = filter_out(lista13, pp);
-  std::cout << "lista13" << std::endl;
-  std::cout << lista12 << std::endl;
-  lista12 = filter_out(lista13, pd);
-  std::cout << "lista13" << std::endl;
-  std::cout << lista12 << std::endl;
-}
-
-int main()
-{
-  test_int();
-  test_string();
-  test_custom();
-
-  return 0;
-}
+#include <iostream>
+#include <ostream>
+#include <cassert>
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <atomic>
+#include <unordered_set>
+#include "set.h"
+#include "ordered_set.h"
+#include "packed_set.h"
+#include "concurrent_set.h"
+#include "snapshot_set.h"
+#include "mapped_set.h"
+#include "int_set.h"
+#include "interned_string.h"
+#include "cow_set.h"
+#include "persistent_set.h"
+#include <cstdio>
+
+/**
+ * @brief Funtore di uguaglianza tra tipi interi
+ * 
+ */
+struct confronto_interi
+{
+  bool operator()(int a, int b) const
+  {
+    return a == b;
+  }
+};
+/**
+ * @brief Funtore di uguaglianza tra tipi stringhe
+ * 
+ */
+struct confronto_stringhe
+{
+  bool operator()(const std::string &a, const std::string &b) const
+  {
+    return (a == b);
+  }
+};
+/**
+ * @brief Struttura del punto
+ * Punto a due dimensioni, banalmente copiabile: si può salvare su file
+ * e confrontare bit a bit
+ */
+struct punto
+{
+  int x; ///< coordinata x del punto
+  int y; ///< coordinata y del punto
+
+  /**
+   * @brief Costruttore di default
+   * @post x == 0
+   * @post y == 0
+   */
+  punto() : x(0), y(0) {}
+  /**
+   * @brief Costruttore Secondario
+   * 
+   * @param xx valore da copiare nella coordinata x
+   * @param yy valore da copaire nella coordinata y
+   * @post x == xx
+   * @post y == yy
+   */
+  punto(int xx, int yy) : x(xx), y(yy) {}
+  /**
+   * @brief Copy constructor
+   * 
+   * @param other punto da copiare
+   * @post x = other.x
+   * @post y = other.y
+   */
+  punto(const punto &other) = default;
+
+  /**
+   * @brief Operatore di assegnamento
+   * 
+   * @param other punto da copiare
+   * @return ritorna un punto con coordinate preso dal punto passato alla funzione
+   */
+  punto &operator=(const punto &other) = default;
+  /**
+   * @brief Operatore di uguaglianza tra due punti
+   * Verifica che entrambe le coordinate dei due punti siano uguali
+   * @param other punto da confrontare
+   * @return true se i punti sono uguali
+   * @return false se i punti sono diversi
+   */
+  bool operator==(const punto &other)const{
+    return x == other.x && y == other.y;
+  }
+  /**
+   * @brief Operatore di disuguaglianza tra due punti
+   * Verifica che entrambe le coordinate dei due punti siano diverse
+   * @param other punto da confrontare
+   * @return true se i punti sono diversi
+   * @return false se i punti sono uguali
+   */
+  bool operator!=(const punto &other)const{
+    return (x != other.x | y != other.y);
+  }
+  /**
+      Distruttore. 
+    */
+  ~punto() = default;
+
+  /**
+ * @brief Funzione di stream
+ *  Ridefinizione dell'operatore di stream per un punto.
+    Necessario per l'operatore di stream della classe set.
+ * 
+ * @param os os stream di output
+ * @param p punto da spedire sullo stream
+ * @return lo stream di output  
+ */
+friend std::ostream &operator<<(std::ostream &os, const punto &p)
+{
+  os << "(" << p.x << "," << p.y << ")";
+  return os;
+}
+};
+
+/**
+ * @brief Funtore di uguaglianza tra tipi punto
+ * 
+ */
+struct confronto_punti
+{
+  bool operator()(const punto &p1, const punto &p2) const
+  {
+    return (p1.x == p2.x && p1.y == p2.y);
+  }
+};
+/**
+ * confronto_interi e confronto_punti confrontano tutti i byte dei loro
+ * elementi, quindi packed_set può usare la ricerca vettoriale
+ */
+template <>
+struct confronto_bit_a_bit<confronto_interi> : std::true_type
+{
+};
+
+template <>
+struct confronto_bit_a_bit<confronto_punti> : std::true_type
+{
+};
+
+/**
+ * @brief Funtore predicato interi
+ * Ritorna true se il valore intero passato è pari
+ */
+struct int_pari
+{
+  bool operator()(int i) const
+  {
+    return (i % 2 == 0);
+  }
+};
+/**
+ * @brief Funtore predicato interi
+ * Ritorna true se il valore intero passato è dispari
+ */
+struct int_dispari
+{
+  bool operator()(int i) const
+  {
+    return (i % 2 != 0);
+  }
+};
+/**
+ * @brief Funtore predicato stringhe
+ * Ritorna true se la lunghezza della stringa passata è pari
+ */
+struct string_pari
+{
+  bool operator()(std::string i) const
+  {
+    return (i.size() % 2 == 0);
+  }
+};
+/**
+ * @brief Funtore predicato stringhe
+ * Ritorna true se la lunghezza della stringa passata è dispari
+ */
+struct string_dispari
+{
+  bool operator()(std::string i) const
+  {
+    return (i.size() % 2 != 0);
+  }
+};
+/**
+ * @brief Funtore predicato punti
+ * Ritorna true se entrambe le coordinate del punto sono pari
+ */
+struct punto_pari
+{
+  bool operator()(punto i) const
+  {
+    return (i.x % 2 == 0 && i.y % 2 == 0);
+  }
+};
+/**
+ * @brief Funtore predicato punti
+ * Ritorna true se entrambe le coordinate del punto sono dispari
+ */
+struct punto_dispari
+{
+  bool operator()(punto i) const
+  {
+    return (i.x % 2 != 0 && i.y % 2 != 0);
+  }
+};
+
+/** 
+ * Nel seguente metodo vengono effettuati tutti i test su un set di interi
+ */
+void test_int()
+{
+
+  set<int, confronto_interi> lista1;
+  set<int, confronto_interi> lista2(lista1);
+  set<int, confronto_interi> lista4;
+  assert(lista1.size() == 0);
+  assert(lista2.size() == 0);
+  for (int i = 0; i < 10; i++)
+  {
+    lista1.add(i);
+  }
+  assert(lista1.size() == 10);
+  set<int, confronto_interi> lista3(lista1);
+  assert(lista3.size() == 10);
+  lista4 = lista1;
+  assert(lista4.size() == 10);
+  assert(lista1 == lista3);
+  lista1.svuota();
+  assert(lista1.size() == 0);
+  lista4.remove(0);
+  std::cout << lista4 << std::endl;
+  lista4.remove(9);
+  std::cout << lista4 << std::endl;
+  lista4.remove(4);
+  std::cout << lista4 << std::endl;
+  assert(lista4.size() == 7);
+  lista4.add(1);
+  int vett[4] = {1, 2, 3, 4};
+  set<int, confronto_interi> lista5(vett, vett + 4);
+  std::cout << lista5 << std::endl;
+  assert(lista4.cerca(5));
+  assert(lista4.cerca(1));
+  assert(lista4.cerca(8));
+  assert(!lista4.cerca(10));
+  set<int, confronto_interi> lista6;
+  set<int, confronto_interi> lista7;
+  lista6.add(1);
+  lista6.add(4);
+  lista7.add(1);
+  lista7.add(4);
+  std::cout << "lista6" << std::endl;
+  std::cout << lista6 << std::endl;
+  std::cout << "lista7" << std::endl;
+  std::cout << lista7 << std::endl;
+  assert(!(lista6 == lista1));
+  assert(!(lista1 == lista4));
+  assert(lista1 == lista2);
+  assert(lista6 == lista7);
+  assert(lista4[2]);
+  assert(lista4[0]);
+  assert(lista4[6]);
+  std::cout << lista4[2] << std::endl;
+
+  int v[5] = {1, 5, 9, 3, 0};
+  set<int, confronto_interi> lista8(v, v + 5);
+  set<int, confronto_interi>::const_iterator i, b, e;
+  assert(b == e);
+  i = lista8.begin();
+  set<int, confronto_interi>::const_iterator ii(i);
+  assert(i == ii);
+  assert((*i) == (*ii));
+  i++;
+  ii++;
+  assert(i == ii);
+  assert((*i) == (*ii));
+  ++i;
+  ii++;
+  assert(i == ii);
+  assert((*i) == (*ii));
+
+  assert(*i == 9 && *ii == 9);
+  i++;
+  assert(i != ii);
+  assert((*i) != (*ii));
+  const int *p = &(*i);
+  assert(*p == 3);
+  i = ii;
+  assert(i == ii);
+  set<int, confronto_interi> lista9;
+  set<int, confronto_interi> lista10;
+  set<int, confronto_interi> lista11;
+  lista9.add(1);
+  lista9.add(4);
+  lista9.add(7);
+  lista10.add(1);
+  lista10.add(4);
+  lista10.add(8);
+  std::cout << "lista9" << std::endl;
+  std::cout << lista9 << std::endl;
+  std::cout << "lista10" << std::endl;
+  std::cout << lista10 << std::endl;
+  lista11 = lista9 + lista10;
+  std::cout << lista11 << std::endl;
+  lista11 = lista9 - lista10;
+  std::cout << lista11 << std::endl;
+  set<int, confronto_interi> lista12;
+  set<int, confronto_interi> lista13;
+  lista13.add(2);
+  lista13.add(4);
+  lista13.add(9);
+  int_pari ip;
+  int_dispari id;
+  lista12 = filter_out(lista13, ip);
+  std::cout << "lista13" << std::endl;
+  std::cout << lista12 << std::endl;
+  lista12 = filter_out(lista13, id);
+  std::cout << "lista13" << std::endl;
+  std::cout << lista12 << std::endl;
+}
+/** 
+ * Nel seguente metodo vengono effettuati tutti i test su un set di stringhe
+ */
+void test_string()
+{
+
+  set<std::string, confronto_stringhe> lista1;
+  set<std::string, confronto_stringhe> lista2(lista1);
+  set<std::string, confronto_stringhe> lista4;
+  assert(lista1.size() == 0);
+  assert(lista2.size() == 0);
+  lista1.add("pippo");
+  lista1.add("pluto");
+  lista1.add("paperino");
+  lista1.add("cip");
+  lista1.add("cip");
+  //std::cout<<lista1<<std::endl;
+  assert(lista1.size() == 4);
+  set<std::string, confronto_stringhe> lista3(lista1);
+  assert(lista3.size() == 4);
+  lista4 = lista1;
+  assert(lista4.size() == 4);
+  assert(lista1 == lista3);
+  lista1.svuota();
+  assert(lista1.size() == 0);
+  lista4.remove("pippo");
+  std::cout << lista4 << std::endl;
+  lista4.remove("cip");
+  std::cout << lista4 << std::endl;
+  lista4.remove("pluto");
+  std::cout << lista4 << std::endl;
+  assert(lista4.size() == 1);
+  lista4.add("pippo");
+  lista4.add("pluto");
+  std::string vett[4] = {"pippo", "pluto", "paperino", "cip"};
+  set<std::string, confronto_stringhe> lista5(vett, vett + 4);
+  std::cout << lista5 << std::endl;
+  assert(lista4.cerca("pluto"));
+  assert(lista4.cerca("paperino"));
+  assert(lista4.cerca("pippo"));
+  assert(!lista4.cerca("cip"));
+  std::string s = lista4[2];
+  set<std::string, confronto_stringhe> lista6;
+  set<std::string, confronto_stringhe> lista7;
+  lista6.add("pippo");
+  lista6.add("pluto");
+  lista7.add("pippo");
+  lista7.add("pluto");
+  std::cout << "lista6" << std::endl;
+  std::cout << lista6 << std::endl;
+  std::cout << "lista7" << std::endl;
+  std::cout << lista7 << std::endl;
+  assert(!(lista6 == lista1));
+  assert(!(lista1 == lista4));
+  assert(lista1 == lista2);
+  assert(lista6 == lista7);
+  std::cout << lista4[1] << std::endl;
+  std::cout << lista4[0] << std::endl;
+  std::cout << lista4[2] << std::endl;
+
+  std::string v[4] = {"pippo", "pluto", "paperino", "cip"};
+  set<std::string, confronto_stringhe> lista8(v, v + 4);
+  set<std::string, confronto_stringhe>::const_iterator i, b, e;
+  assert(b == e);
+  i = lista8.begin();
+  set<std::string, confronto_stringhe>::const_iterator ii(i);
+  assert(i == ii);
+  assert((*i) == (*ii));
+  i++;
+  ii++;
+  assert(i == ii);
+  assert((*i) == (*ii));
+  ++i;
+  ii++;
+  assert(i == ii);
+  assert((*i) == (*ii));
+
+  assert((*i) == "paperino" && *ii == "paperino");
+  i++;
+  assert(i != ii);
+  assert((*i) != (*ii));
+  const std::string *p = &(*i);
+  assert(*p == "cip");
+  i = ii;
+  assert(i == ii);
+  set<std::string, confronto_stringhe> lista9;
+  set<std::string, confronto_stringhe> lista10;
+  set<std::string, confronto_stringhe> lista11;
+  lista9.add("pippo");
+  lista9.add("pluto");
+  lista9.add("paperino");
+  lista10.add("pippo");
+  lista10.add("pluto");
+  lista10.add("cip");
+  std::cout << "lista9" << std::endl;
+  std::cout << lista9 << std::endl;
+  std::cout << "lista10" << std::endl;
+  std::cout << lista10 << std::endl;
+  lista11 = lista9 + lista10;
+  std::cout << lista11 << std::endl;
+  lista11 = lista9 - lista10;
+  std::cout << lista11 << std::endl;
+  set<std::string, confronto_stringhe> lista12;
+  set<std::string, confronto_stringhe> lista13;
+  lista13.add("qwer");
+  lista13.add("pippo");
+  lista13.add("pluto");
+  string_pari sp;
+  string_dispari sd;
+  lista12 = filter_out(lista13, sp);
+  std::cout << "lista13" << std::endl;
+  std::cout << lista12 << std::endl;
+  lista12 = filter_out(lista13, sd);
+  std::cout << "lista13" << std::endl;
+  std::cout << lista12 << std::endl;
+}
+/** 
+ * Nel seguente metodo vengono effettuati tutti i test su un set di punti
+ */
+void test_custom()
+{
+  set<punto, confronto_punti> lista1;
+  set<punto, confronto_punti> lista2(lista1);
+  set<punto, confronto_punti> lista4;
+  assert(lista1.size() == 0);
+  assert(lista2.size() == 0);
+  punto punto1(1, 2);
+  punto punto2(3, 4);
+  punto punto3(5, 6);
+  punto punto4(7, 8);
+  punto punto5(1, 2);
+  lista1.add(punto1);
+  lista1.add(punto2);
+  lista1.add(punto3);
+  lista1.add(punto4);
+  lista1.add(punto5);
+  assert(lista1.size() == 4);
+  set<punto, confronto_punti> lista3(lista1);
+  assert(lista3.size() == 4);
+  lista4 = lista1;
+  assert(lista4.size() == 4);
+  assert(lista1 == lista3);
+  lista1.svuota();
+  assert(lista1.size() == 0);
+  lista4.remove(punto1);
+  std::cout << lista4 << std::endl;
+  lista4.remove(punto4);
+  std::cout << lista4 << std::endl;
+  lista4.remove(punto3);
+  std::cout << lista4 << std::endl;
+  assert(lista4.size() == 1);
+  lista4.add(punto1);
+  lista4.add(punto3);
+  punto vett[4] = {punto1, punto2, punto3, punto4};
+  set<punto, confronto_punti> lista5(vett, vett + 4);
+  std::cout << lista5 << std::endl;
+  assert(lista4.cerca(punto1));
+  assert(lista4.cerca(punto2));
+  assert(lista4.cerca(punto3));
+  assert(!lista4.cerca(punto4));
+  punto s = lista4[2];
+  set<punto, confronto_punti> lista6;
+  set<punto, confronto_punti> lista7;
+  lista6.add(punto1);
+  lista6.add(punto2);
+  lista7.add(punto1);
+  lista7.add(punto2);
+  std::cout << "lista6" << std::endl;
+  std::cout << lista6 << std::endl;
+  std::cout << "lista7" << std::endl;
+  std::cout << lista7 << std::endl;
+  assert(!(lista6 == lista1));
+  assert(!(lista1 == lista4));
+  assert(lista1 == lista2);
+  assert(lista6 == lista7);
+  std::cout << lista4[1] << std::endl;
+  std::cout << lista4[0] << std::endl;
+  std::cout << lista4[2] << std::endl;
+
+  punto setPunti[4] = {punto(-1, 6), punto(1, 1), punto(1, -4), punto(1, -3)};
+  set<punto, confronto_punti> punto20(setPunti, setPunti + 4);
+  set<punto, confronto_punti>::const_iterator i, b, e;
+  assert(b == e);
+  i = punto20.begin();
+  set<punto, confronto_punti>::const_iterator ii(i);
+  assert(i == ii);
+  assert((*i) == (*ii));
+  i++;
+  ii++;
+  assert(i == ii);
+  assert((*i) == (*ii));
+  ++i;
+  ii++;
+  assert(i == ii);
+  assert((*i) == (*ii));
+  assert((*i) == punto(1,-4) && *ii == punto(1,-4));
+  i++;
+  assert(i != ii);
+  assert((*i) != (*ii));
+  const punto *p = &(*i);
+  assert(*p == punto(1, -3));
+  i = ii;
+  assert(i == ii);
+  
+  /*punto v[5] = {punto(-1, -5), punto(0, 0), punto(1, -4), punto(-4, -3), punto(10, 3)};
+  set<punto, confronto_punti> punto8(v, v + 5);
+  set<punto, confronto_punti>::const_iterator i, b, e;
+  assert(b == e);
+  i = punto8.begin();
+  set<punto, confronto_punti>::const_iterator ii(i);
+  assert(i == ii);
+  assert((*i) == (*ii));
+  i++;
+  ii++;
+  assert(i == ii);
+  assert((*i) == (*ii));
+  ++i;
+  ii++;
+  assert(i == ii);
+  assert((*i) == (*ii));
+
+  assert(*i == 9 && *ii == 9);
+  i++;
+  assert(i != ii);
+  assert((*i) != (*ii));
+  const int *p = &(*i);
+  assert(*p == 3);
+  i = ii;
+  assert(i == ii);*/
+
+  set<punto, confronto_punti> lista9;
+  set<punto, confronto_punti> lista10;
+  set<punto, confronto_punti> lista11;
+  lista9.add(punto1);
+  lista9.add(punto2);
+  lista9.add(punto3);
+  lista10.add(punto1);
+  lista10.add(punto2);
+  lista10.add(punto4);
+  std::cout << "lista9" << std::endl;
+  std::cout << lista9 << std::endl;
+  std::cout << "lista10" << std::endl;
+  std::cout << lista10 << std::endl;
+  lista11 = lista9 + lista10;
+  std::cout << "+" << lista11 << std::endl;
+  lista11 = lista9 - lista10;
+  std::cout << "-" << lista11 << std::endl;
+  set<punto, confronto_punti> lista12;
+  set<punto, confronto_punti> lista13;
+  punto punto9(2, 4);
+  punto punto6(2, 6);
+  punto punto7(1, 3);
+  punto punto8(3, 7);
+  lista13.add(punto9);
+  lista13.add(punto6);
+  lista13.add(punto7);
+  lista13.add(punto8);
+  punto_pari pp;
+  punto_dispari pd;
+  lista12 = filter_out(lista13, pp);
+  std::cout << "lista13" << std::endl;
+  std::cout << lista12 << std::endl;
+  lista12 = filter_out(lista13, pd);
+  std::cout << "lista13" << std::endl;
+  std::cout << lista12 << std::endl;
+}
+
+/** 
+ * Nel seguente metodo vengono effettuati i test sui set con indice hash
+ */
+void test_hash()
+{
+  typedef set<int, confronto_interi, std::hash<int> > set_interi;
+  set_interi lista1;
+  for (int i = 0; i < 1000; i++)
+  {
+    lista1.add(i * 7);
+  }
+  assert(lista1.size() == 1000);
+  assert(lista1.cerca(0));
+  assert(lista1.cerca(6993));
+  assert(!lista1.cerca(6994));
+  lista1.add(14);
+  assert(lista1.size() == 1000);
+  for (int i = 0; i < 1000; i += 2)
+  {
+    lista1.remove(i * 7);
+  }
+  assert(lista1.size() == 500);
+  assert(!lista1.cerca(0));
+  assert(lista1.cerca(7));
+  lista1.remove(0);
+  assert(lista1.size() == 500);
+
+  // l'ordine di iterazione resta quello di inserimento
+  int atteso = 7;
+  for (set_interi::const_iterator i = lista1.begin(); i != lista1.end(); ++i)
+  {
+    assert(*i == atteso);
+    atteso += 14;
+  }
+  assert(lista1[0] == 7 && lista1[499] == 6993);
+  lista1.remove(21);
+  assert(lista1[1] == 35 && lista1[498] == 6993);
+  lista1.add(21);
+  assert(lista1[498] == 6993 && lista1[499] == 21);
+  lista1.remove(21);
+
+  set_interi lista2(lista1);
+  assert(lista2 == lista1);
+  lista2.remove(6993);
+  lista2.add(6993);
+  assert(lista2 == lista1);
+  lista2.remove(7);
+  assert(!(lista2 == lista1));
+  set_interi lista3;
+  lista3 = lista2;
+  lista3.add(7);
+  assert(lista3 == lista1);
+  lista3.svuota();
+  assert(lista3.size() == 0 && !lista3.cerca(7));
+  lista3.add(7);
+  assert(lista3.size() == 1 && lista3.cerca(7));
+
+  set<std::string, confronto_stringhe, std::hash<std::string> > lista4;
+  lista4.add("pippo");
+  lista4.add("pluto");
+  lista4.add("paperino");
+  set<std::string, confronto_stringhe, std::hash<std::string> > lista5;
+  lista5.add("pluto");
+  lista5.add("cip");
+  assert((lista4 + lista5).size() == 4);
+  assert((lista4 - lista5).size() == 1);
+  assert((lista4 - lista5).cerca("pluto"));
+  assert(filter_out(lista4, string_dispari()).size() == 2);
+  std::cout << lista4 << std::endl;
+}
+
+/** 
+ * Nel seguente metodo vengono effettuati i test sugli ordered_set
+ */
+void test_ordered()
+{
+  typedef ordered_set<int, std::less<int> > set_ordinato;
+  int v[8] = {9, 3, 7, 1, 3, 5, 9, 11};
+  set_ordinato lista1(v, v + 8);
+  assert(lista1.size() == 6);
+  assert(lista1[0] == 1 && lista1[5] == 11);
+  lista1.add(4);
+  lista1.add(4);
+  assert(lista1.size() == 7 && lista1[2] == 4);
+  assert(lista1.cerca(7) && !lista1.cerca(8));
+  lista1.remove(7);
+  lista1.remove(8);
+  assert(lista1.size() == 6 && !lista1.cerca(7));
+  assert(*lista1.lower_bound(6) == 9);
+  assert(*lista1.upper_bound(9) == 11);
+  std::pair<set_ordinato::const_iterator, set_ordinato::const_iterator> r = lista1.range(3, 10);
+  assert(std::distance(r.first, r.second) == 4);
+  std::cout << lista1 << std::endl;
+
+  int w[5] = {2, 4, 6, 9, 12};
+  set_ordinato lista2(w, w + 5);
+  set_ordinato lista3 = lista1 + lista2;
+  assert(lista3.size() == 9);
+  for (unsigned int i = 1; i < lista3.size(); i++)
+  {
+    assert(lista3[i - 1] < lista3[i]);
+  }
+  lista3 = lista1 - lista2;
+  assert(lista3.size() == 2 && lista3[0] == 4 && lista3[1] == 9);
+  lista3 = filter_out(lista2, int_pari());
+  assert(lista3.size() == 4);
+  int z[2] = {9, 4};
+  assert(lista3 == set_ordinato(w, w + 4) + set_ordinato(w + 4, w + 5) - lista3);
+  assert(lista1 - lista2 == set_ordinato(z, z + 2));
+  lista3.svuota();
+  assert(lista3.is_empty());
+
+  std::string s[3] = {"pluto", "cip", "pippo"};
+  ordered_set<std::string, std::less<std::string> > lista4(s, s + 3);
+  assert(lista4[0] == "cip" && lista4[2] == "pluto");
+  std::cout << lista4 << std::endl;
+}
+
+/** 
+ * Nel seguente metodo vengono effettuati i test sui set che allocano da un'arena
+ */
+void test_arena()
+{
+  arena a(1024);
+  set<int, confronto_interi, std::hash<int> > lista1(a);
+  set<std::string, confronto_stringhe> lista2(a);
+  for (int i = 0; i < 100; i++)
+  {
+    lista1.add(i);
+    lista2.add(std::string(20, static_cast<char>('a' + i % 26)));
+  }
+  assert(lista1.size() == 100 && lista2.size() == 26);
+  for (int i = 0; i < 100; i += 3)
+  {
+    lista1.remove(i);
+  }
+  assert(lista1.size() == 66);
+  for (int i = 0; i < 100; i += 3)
+  {
+    lista1.add(i);
+  }
+  assert(lista1.size() == 100 && lista1.cerca(99));
+
+  set<int, confronto_interi, std::hash<int> > lista3(lista1, a);
+  set<int, confronto_interi, std::hash<int> > lista4;
+  assert(lista3 == lista1);
+  lista4 = lista3;
+  lista3 = lista4;
+  assert(lista3 == lista1 && lista4 == lista1);
+  lista1.svuota();
+  assert(lista1.size() == 0 && !lista1.cerca(5));
+  lista1.add(5);
+  assert(lista1.size() == 1 && lista1.cerca(5));
+  lista2.svuota();
+  lista2.add("pippo");
+  assert(lista2.cerca("pippo"));
+}
+
+/** 
+ * Nel seguente metodo vengono effettuati i test sullo spostamento dei set
+ */
+void test_move()
+{
+  typedef set<std::string, confronto_stringhe, std::hash<std::string> > set_stringhe;
+  set_stringhe lista1;
+  std::string s("una stringa abbastanza lunga da stare sullo heap");
+  lista1.add(std::move(s));
+  assert(s.empty());
+  std::string s2("una stringa abbastanza lunga da stare sullo heap");
+  lista1.add(std::move(s2));
+  assert(!s2.empty());
+  lista1.emplace(3, 'x');
+  lista1.emplace("xxx");
+  assert(lista1.size() == 2 && lista1.cerca("xxx"));
+
+  set_stringhe lista2(std::move(lista1));
+  assert(lista1.size() == 0 && lista2.size() == 2);
+  lista1.add("pippo");
+  assert(lista1.size() == 1 && lista1.cerca("pippo"));
+  lista1 = std::move(lista2);
+  assert(lista1.size() == 2 && lista2.size() == 0 && !lista1.cerca("pippo"));
+
+  set_stringhe lista3;
+  lista3.add("pippo");
+  lista3.add("pluto");
+  set_stringhe lista4;
+  lista4.add("pluto");
+  lista4.add("cip");
+  set_stringhe lista5 = (lista3 + lista4) + lista1;
+  assert(lista5.size() == 5);
+  assert(lista5[0] == "pippo" && lista5[2] == "cip" && lista5[4] == "xxx");
+  lista5 = (lista3 + lista4) - lista4;
+  assert(lista5 == lista4);
+  lista5 = filter_out(lista3 + lista4, string_dispari());
+  assert(lista5.size() == 3 && lista5[2] == "cip");
+  assert(lista3.size() == 2 && lista4.size() == 2);
+
+  // + e - su una set temporanea riusano i suoi nodi
+  set_stringhe lista7(lista3);
+  const std::string *primo = &*lista7.begin();
+  set_stringhe lista8 = std::move(lista7) + lista4;
+  assert(lista7.size() == 0 && lista8.size() == 3 && &*lista8.begin() == primo);
+  assert(lista8[0] == "pippo" && lista8[1] == "pluto" && lista8[2] == "cip");
+  primo = &lista8[1];
+  set_stringhe lista9 = std::move(lista8) - lista4;
+  assert(lista8.size() == 0 && lista9.size() == 2 && &*lista9.begin() == primo);
+  assert(lista9[0] == "pluto" && lista9[1] == "cip" && lista9 == lista4);
+
+  set<punto, confronto_punti> lista6;
+  lista6.emplace(1, 2);
+  lista6.emplace(1, 2);
+  lista6.add(punto(3, 4));
+  assert(lista6.size() == 2 && lista6.cerca(punto(3, 4)));
+}
+
+/** 
+ * Nel seguente metodo vengono effettuati i test sul caricamento di sequenze
+ */
+void test_insert()
+{
+  std::vector<int> v;
+  for (int i = 0; i < 100000; i++)
+  {
+    v.push_back(i % 70000);
+  }
+  set<int, confronto_interi, std::hash<int> > lista1(v.begin(), v.end());
+  assert(lista1.size() == 70000);
+  assert(lista1[0] == 0 && lista1[69999] == 69999);
+  int w[4] = {69999, 70000, 70001, 70000};
+  lista1.insert(w, w + 4);
+  assert(lista1.size() == 70002 && lista1[70001] == 70001);
+
+  std::istringstream is("3 1 4 1 5 9 2 6 5 3 5");
+  set<int, confronto_interi> lista2((std::istream_iterator<int>(is)), std::istream_iterator<int>());
+  assert(lista2.size() == 7 && lista2[6] == 6);
+
+  // una conversione che fallisce lascia la set com'era
+  set<std::string, confronto_stringhe> lista3;
+  lista3.add("pippo");
+  const char *c[3] = {"pluto", "paperino", nullptr};
+  try
+  {
+    lista3.insert(c, c + 3);
+    assert(false);
+  }
+  catch (const std::logic_error &)
+  {
+  }
+  assert(lista3.size() == 1 && lista3.cerca("pippo") && !lista3.cerca("pluto"));
+  lista3.insert(c, c + 2);
+  assert(lista3.size() == 3);
+}
+
+/** 
+ * Nel seguente metodo vengono effettuati i test sulle statistiche dei set
+ */
+void test_stats()
+{
+  set<int, confronto_interi, void, con_statistiche> lista1;
+  for (int i = 0; i < 10; i++)
+  {
+    lista1.add(i);
+  }
+  lista1.add(3);
+  lista1.add(9);
+  statistiche_set st = lista1.stats();
+  assert(st.aggiunte == 10 && st.duplicati == 2);
+  assert(st.ricerche == 12 && st.confronti == 45 + 4 + 10);
+  assert(st.allocazioni == 10 && st.liberazioni == 0);
+  assert(st.byte_in_uso > 0);
+  assert(lista1.cerca(0) && !lista1.cerca(42));
+  lista1.remove(5);
+  st = lista1.stats();
+  assert(st.ricerche == 15 && st.rimozioni == 1 && st.liberazioni == 1);
+  lista1.svuota();
+  st = lista1.stats();
+  assert(st.liberazioni == 10 && st.byte_in_uso == 0);
+  std::cout << st << std::endl;
+
+  set<int, confronto_interi, std::hash<int>, con_statistiche> lista2;
+  for (int i = 0; i < 1000; i++)
+  {
+    lista2.add(i);
+    lista2.cerca(i);
+  }
+  st = lista2.stats();
+  assert(st.ricerche == 2000 && st.confronti == 1000);
+  assert(st.confronti_per_ricerca() == 0.5);
+  set<int, confronto_interi, std::hash<int>, con_statistiche> lista3(lista2);
+  // la copia parte con contatori propri: le ricerche di lista2 non passano
+  assert(lista3.stats().aggiunte == 1000 && lista3.stats().duplicati == 0);
+  assert(lista3.stats().ricerche == 0 && lista3.stats().confronti == 0);
+
+  // senza politica i contatori restano a zero
+  set<int, confronto_interi> lista4;
+  lista4.add(1);
+  lista4.add(1);
+  assert(lista4.stats().aggiunte == 0 && lista4.size() == 1);
+}
+
+/** 
+ * Nel seguente metodo vengono effettuati i test sui packed_set
+ */
+void test_packed()
+{
+  packed_set<int, confronto_interi> lista1;
+  for (int i = 0; i < 100; i++)
+  {
+    lista1.add(i * 3);
+    lista1.add(i * 3);
+  }
+  assert(lista1.size() == 100);
+  for (int i = 0; i < 300; i++)
+  {
+    assert(lista1.cerca(i) == (i % 3 == 0));
+  }
+  lista1.remove(0);
+  lista1.remove(297);
+  lista1.remove(150);
+  lista1.remove(1);
+  assert(lista1.size() == 97 && lista1[0] == 3 && lista1[96] == 294);
+  assert(!lista1.cerca(150) && lista1.cerca(153));
+
+  packed_set<punto, confronto_punti> lista2;
+  for (int i = 0; i < 40; i++)
+  {
+    lista2.add(punto(i, -i));
+  }
+  lista2.add(punto(7, -7));
+  assert(lista2.size() == 40);
+  assert(lista2.cerca(punto(39, -39)) && !lista2.cerca(punto(39, 39)));
+  assert(!lista2.cerca(punto(-7, 7)));
+  lista2.remove(punto(5, -5));
+  assert(lista2.size() == 39 && lista2[5] == punto(6, -6));
+
+  int v[6] = {1, 2, 3, 4, 5, 6};
+  int w[4] = {4, 5, 6, 7};
+  packed_set<int, confronto_interi> lista3(v, v + 6);
+  packed_set<int, confronto_interi> lista4(w, w + 4);
+  assert((lista3 + lista4).size() == 7);
+  assert((lista3 - lista4).size() == 3 && (lista3 - lista4)[0] == 4);
+  assert(filter_out(lista3, int_pari()).size() == 3);
+  assert(lista3 - lista4 == lista4 - lista3);
+  std::cout << lista3 << std::endl;
+
+  packed_set<std::string, confronto_stringhe> lista5;
+  lista5.add("pippo");
+  lista5.add("pippo");
+  assert(lista5.size() == 1 && lista5.cerca("pippo"));
+}
+
+/** 
+ * Nel seguente metodo vengono effettuati i test sulle operazioni parallele
+ */
+void test_parallelo()
+{
+  typedef set<int, confronto_interi, std::hash<int> > set_interi;
+  set_interi lista1;
+  set_interi lista2;
+  for (int i = 0; i < 20000; i++)
+  {
+    lista1.add(i);
+    lista2.add(i * 2 + 1);
+  }
+  for (unsigned int t = 1; t <= 4; t++)
+  {
+    parallelo p(t);
+    set_interi lista3 = unione(p, lista1, lista2);
+    assert(lista3 == lista1 + lista2);
+    assert(lista3.size() == 30000 && lista3[19999] == 19999 && lista3[20000] == 20001);
+    set_interi lista4 = intersezione(p, lista1, lista2);
+    assert(lista4 == lista1 - lista2 && lista4.size() == 10000);
+    set_interi lista5 = filter_out(p, lista1, int_pari());
+    assert(lista5 == filter_out(lista1, int_pari()) && lista5[1] == 2);
+  }
+
+  set<std::string, confronto_stringhe> lista6;
+  set<std::string, confronto_stringhe> lista7;
+  lista6.add("pippo");
+  lista6.add("pluto");
+  lista7.add("pluto");
+  lista7.add("cip");
+  assert(unione(parallelo(), lista6, lista7).size() == 3);
+  assert(intersezione(parallelo(), lista6, lista7).cerca("pluto"));
+}
+
+/** 
+ * Nel seguente metodo vengono effettuati i test sulla concurrent_set
+ */
+void test_concurrent()
+{
+  concurrent_set<int, confronto_interi, std::hash<int> > lista1(8);
+  assert(lista1.add(1) && !lista1.add(1));
+  assert(lista1.cerca(1) && !lista1.cerca(2));
+  assert(lista1.remove(1) && !lista1.remove(1));
+  assert(lista1.size() == 0);
+
+  // 4 thread inseriscono intervalli sovrapposti e poi rimuovono i dispari
+  std::vector<std::thread> thread;
+  for (int t = 0; t < 4; t++)
+  {
+    thread.push_back(std::thread([&lista1, t]() {
+      for (int i = t * 500; i < t * 500 + 1000; i++)
+        lista1.add(i);
+      for (int i = t * 500; i < t * 500 + 1000; i++)
+        if (i % 2 != 0)
+          lista1.remove(i);
+    }));
+  }
+  for (unsigned int t = 0; t < thread.size(); t++)
+    thread[t].join();
+  assert(lista1.size() == 1250);
+  assert(lista1.cerca(0) && lista1.cerca(2498) && !lista1.cerca(2499));
+
+  set<int, confronto_interi, std::hash<int> > lista2 = lista1.istantanea();
+  assert(lista2.size() == 1250 && filter_out(lista2, int_pari()).size() == 1250);
+  lista1.svuota();
+  assert(lista1.size() == 0 && !lista1.cerca(0));
+
+  concurrent_set<std::string, confronto_stringhe, std::hash<std::string> > lista3;
+  lista3.add("pippo");
+  lista3.add("pluto");
+  int n = 0;
+  lista3.per_ogni([&n](const std::string &) { n++; });
+  assert(n == 2);
+}
+
+/** 
+ * Nel seguente metodo vengono effettuati i test sulla snapshot_set
+ */
+void test_snapshot()
+{
+  snapshot_set<int, confronto_interi, std::hash<int> > lista1;
+  lista1.add(1);
+  lista1.add(2);
+  lista1.add(2);
+  assert(lista1.size() == 2 && lista1.cerca(2) && !lista1.cerca(3));
+
+  {
+    snapshot_set<int, confronto_interi, std::hash<int> >::lettura l = lista1.leggi();
+    assert(l->size() == 2 && l->cerca(1) && *l->begin() == 1);
+  }
+  lista1.remove(1);
+  assert(!lista1.cerca(1));
+
+  lista1.modifica([](set<int, confronto_interi, std::hash<int> > &s) {
+    for (int i = 0; i < 100; i++)
+      s.add(i);
+  });
+  assert(lista1.size() == 100);
+
+  // modifica che fallisce: la versione pubblicata non cambia
+  try
+  {
+    lista1.modifica([](set<int, confronto_interi, std::hash<int> > &s) {
+      s.remove(0);
+      throw std::runtime_error("modifica annullata");
+    });
+    assert(false);
+  }
+  catch (const std::runtime_error &)
+  {
+  }
+  assert(lista1.cerca(0) && lista1.size() == 100);
+
+  // lettori concorrenti mentre uno scrittore aggiunge e rimuove
+  std::atomic<bool> fine(false);
+  std::vector<std::thread> lettori;
+  for (int t = 0; t < 3; t++)
+  {
+    lettori.push_back(std::thread([&lista1, &fine]() {
+      while (!fine.load())
+      {
+        snapshot_set<int, confronto_interi, std::hash<int> >::lettura l = lista1.leggi();
+        unsigned int n = 0;
+        for (set<int, confronto_interi, std::hash<int> >::const_iterator i = l->begin(); i != l->end(); ++i)
+          n++;
+        assert(n == l->size() && l->cerca(50));
+      }
+    }));
+  }
+  for (int i = 100; i < 300; i++)
+  {
+    lista1.add(i);
+    lista1.remove(i);
+  }
+  fine.store(true);
+  for (unsigned int t = 0; t < lettori.size(); t++)
+    lettori[t].join();
+  assert(lista1.size() == 100 && lista1.cerca(99) && !lista1.cerca(150));
+
+  set<int, confronto_interi, std::hash<int> > lista2;
+  lista2.add(7);
+  lista1.sostituisci(std::move(lista2));
+  assert(lista1.size() == 1 && lista1.cerca(7));
+}
+
+/** 
+ * Nel seguente metodo vengono effettuati i test sul prefiltro
+ */
+void test_prefiltro()
+{
+  set<int, confronto_interi, std::hash<int>, con_statistiche> lista1;
+  lista1.abilita_prefiltro(0.01);
+  for (int i = 0; i < 5000; i++)
+  {
+    lista1.add(i);
+  }
+  assert(lista1.size() == 5000);
+  for (int i = 0; i < 5000; i++)
+  {
+    assert(lista1.cerca(i));
+  }
+
+  // le rimozioni non lasciano falsi negativi
+  for (int i = 0; i < 5000; i += 2)
+  {
+    lista1.remove(i);
+  }
+  for (int i = 0; i < 5000; i++)
+  {
+    assert(lista1.cerca(i) == (i % 2 != 0));
+  }
+
+  statistiche_set st = lista1.stats();
+  unsigned long negative = st.prefiltrate + st.falsi_positivi;
+  for (int i = 10000; i < 20000; i++)
+  {
+    assert(!lista1.cerca(i));
+  }
+  st = lista1.stats();
+  assert(st.prefiltrate + st.falsi_positivi == negative + 10000);
+  assert(st.falsi_positivi_osservati() < 0.05);
+  assert(lista1.falsi_positivi_prefiltro() > 0 && lista1.falsi_positivi_prefiltro() < 0.05);
+
+  // la copia ha il proprio prefiltro
+  set<int, confronto_interi, std::hash<int>, con_statistiche> lista2(lista1);
+  assert(lista2 == lista1 && lista2.cerca(4999) && !lista2.cerca(4998));
+  lista1.svuota();
+  assert(!lista1.cerca(1) && lista2.cerca(1));
+  lista1.add(1);
+  assert(lista1.cerca(1) && lista1.size() == 1);
+  lista1.disabilita_prefiltro();
+  assert(lista1.cerca(1) && lista1.falsi_positivi_prefiltro() == 0);
+
+  // senza indice il prefiltro usa la funzione passata
+  set<std::string, confronto_stringhe, void, con_statistiche> lista3;
+  lista3.add("pippo");
+  lista3.abilita_prefiltro(0.001, std::hash<std::string>());
+  lista3.add("pluto");
+  lista3.add("pippo");
+  assert(lista3.size() == 2 && lista3.cerca("pippo") && lista3.cerca("pluto"));
+  assert(!lista3.cerca("paperino") && lista3.stats().prefiltrate > 0);
+  lista3.remove("pippo");
+  assert(!lista3.cerca("pippo") && lista3.cerca("pluto"));
+}
+
+/** 
+ * Nel seguente metodo vengono effettuati i test sulle operazioni batch
+ */
+void test_batch()
+{
+  std::vector<int> chiavi;
+  for (int i = 0; i < 1000; i++)
+  {
+    chiavi.push_back(i * 3);
+  }
+  chiavi.push_back(6);
+
+  set<int, confronto_interi, std::hash<int> > lista1;
+  lista1.add(3);
+  lista1.add_batch(chiavi.begin(), chiavi.end());
+  assert(lista1.size() == 1000 && lista1[0] == 3 && lista1[1] == 0);
+
+  set<int, confronto_interi> lista2;
+  lista2.add(3);
+  lista2.add_batch(chiavi.begin(), chiavi.end());
+  assert(lista2.size() == 1000 && lista2[0] == 3 && lista2[1] == 0 && lista2[999] == 2997);
+
+  std::vector<int> cercate;
+  for (int i = 0; i < 3000; i += 2)
+  {
+    cercate.push_back(i);
+  }
+  std::vector<bool> esito1 = lista1.cerca_batch(cercate.begin(), cercate.end());
+  std::vector<bool> esito2 = lista2.cerca_batch(cercate.begin(), cercate.end());
+  assert(esito1.size() == cercate.size() && esito1 == esito2);
+  for (unsigned int i = 0; i < cercate.size(); i++)
+  {
+    assert(esito1[i] == (cercate[i] % 3 == 0));
+  }
+
+  lista1.remove_batch(cercate.begin(), cercate.end());
+  lista2.remove_batch(cercate.begin(), cercate.end());
+  assert(lista1.size() == 500 && lista2.size() == 500);
+  for (unsigned int i = 0; i < lista1.size(); i++)
+  {
+    assert(lista1[i] == lista2[i]);
+  }
+  assert(!lista1.cerca(6) && lista1.cerca(3) && lista2.cerca(2997));
+  lista2.remove_batch(chiavi.begin(), chiavi.end());
+  assert(lista2.is_empty());
+
+  // senza indice il prefiltro respinge le chiavi prima della passata
+  set<std::string, confronto_stringhe, void, con_statistiche> lista3;
+  lista3.abilita_prefiltro(0.01, std::hash<std::string>());
+  std::string parole[5] = {"pippo", "pluto", "pippo", "paperino", "pluto"};
+  lista3.add_batch(parole, parole + 5);
+  assert(lista3.size() == 3 && lista3[2] == "paperino");
+  std::string cerca[3] = {"pluto", "cip", "ciop"};
+  std::vector<bool> esito3 = lista3.cerca_batch(cerca, cerca + 3);
+  assert(esito3[0] && !esito3[1] && !esito3[2]);
+  lista3.remove_batch(parole, parole + 2);
+  assert(lista3.size() == 1 && lista3.cerca("paperino"));
+}
+
+/** 
+ * Nel seguente metodo vengono effettuati i test sulle espressioni
+ */
+void test_espressioni()
+{
+  typedef set<int, confronto_interi, std::hash<int>, con_statistiche> set_interi;
+  int v[5] = {1, 2, 3, 4, 5};
+  int w[4] = {4, 5, 6, 7};
+  int z[4] = {2, 5, 7, 9};
+  set_interi lista1(v, v + 5);
+  set_interi lista2(w, w + 4);
+  set_interi lista3(z, z + 4);
+
+  // l'espressione non costruisce set finché non viene valutata
+  unsigned long allocazioni = lista1.stats().allocazioni;
+  assert(((lista1 + lista2) - lista3).size() == 3);
+  assert(((lista1 + lista2) - lista3).cerca(7) && !((lista1 + lista2) - lista3).cerca(9));
+  int attesi[3] = {2, 5, 7};
+  int k = 0;
+  // le set operando sono lvalue, quindi l'espressione si può conservare
+  auto espr = (lista1 + lista2) - lista3;
+  for (auto i = espr.begin(); i != espr.end(); ++i)
+  {
+    assert(*i == attesi[k++]);
+  }
+  assert(k == 3 && lista1.stats().allocazioni == allocazioni);
+
+  set_interi lista4 = (lista1 + lista2) - lista3;
+  assert(lista4.size() == 3 && lista4[0] == 2 && lista4[2] == 7);
+  assert(lista4.stats().allocazioni == 3 && lista4.stats().ricerche == 0);
+  assert((lista1 + lista2) - lista3 == lista4);
+
+  set_interi lista5 = lista1 + (lista2 + lista3);
+  assert(lista5.size() == 8 && lista5[5] == 6 && lista5[7] == 9);
+  set_interi lista6 = (lista1 - lista2) + (lista3 - lista2);
+  assert(lista6.size() == 3 && lista6[0] == 4 && lista6[2] == 7);
+  lista6 = lista1 - lista1 - lista1;
+  assert(lista6 == lista1);
+
+  // su una set temporanea il risultato viene calcolato subito
+  set_interi lista7 = set_interi(v, v + 5) + lista2;
+  assert(lista7.size() == 7);
+
+  // set temporanea a sinistra di un'espressione: si valuta l'espressione
+  // e si riusa la set temporanea
+  set_interi lista8 = std::move(lista7) + (lista3 + lista3);
+  assert(lista8.size() == 8 && lista8[7] == 9);
+  lista8 = std::move(lista8) - (lista2 + lista3);
+  assert(lista8.size() == 6 && lista8[0] == 2 && lista8[5] == 9);
+
+  // le set temporanee a destra vengono spostate nell'espressione, che
+  // quindi si può conservare
+  auto crea = [&w]() { return set_interi(w, w + 4); };
+  auto espr2 = lista1 + crea();
+  assert(espr2.size() == 7 && espr2.cerca(6));
+  auto espr3 = (lista1 - crea()) + crea();
+  assert(espr3.size() == 4 && set_interi(espr3) == lista2);
+  std::cout << (lista1 + lista3) << std::endl;
+}
+
+/** 
+ * Nel seguente metodo vengono effettuati i test sugli operatori sul posto
+ * e sulle differenze
+ */
+void test_composti()
+{
+  int v[5] = {1, 2, 3, 4, 5};
+  int w[4] = {4, 5, 6, 7};
+  set<int, confronto_interi, std::hash<int> > lista1(v, v + 5);
+  set<int, confronto_interi, std::hash<int> > lista2(w, w + 4);
+
+  set<int, confronto_interi, std::hash<int> > lista3(lista1);
+  lista3 += lista2;
+  assert(lista3 == lista1 + lista2 && lista3[5] == 6);
+  lista3 += lista3;
+  assert(lista3.size() == 7);
+  lista3 -= lista2;
+  assert(lista3 == lista2 && lista3[0] == 4);
+  lista3 -= lista3;
+  assert(lista3.size() == 4);
+
+  set<int, confronto_interi, std::hash<int> > lista4 = differenza(lista1, lista2);
+  assert(lista4.size() == 3 && lista4[0] == 1 && lista4[2] == 3);
+  assert(differenza(lista2, lista1).size() == 2 && differenza(lista2, lista1)[0] == 6);
+  assert(differenza(set<int, confronto_interi, std::hash<int> >(lista1), lista2) == lista4);
+  lista3 = lista1;
+  lista3.togli(lista2);
+  assert(lista3 == lista4);
+  lista3.togli(lista3);
+  assert(lista3.is_empty());
+
+  set<int, confronto_interi, std::hash<int> > lista5 = differenza_simmetrica(lista1, lista2);
+  assert(lista5.size() == 5 && lista5[2] == 3 && lista5[3] == 6);
+  assert(differenza_simmetrica(set<int, confronto_interi, std::hash<int> >(lista1), lista2) == lista5);
+  lista3 = lista1;
+  lista3.alterna(lista2);
+  assert(lista3 == lista5);
+  lista3.alterna(lista2);
+  assert(lista3 == lista1);
+
+  // accumulatore aggiornato senza ricopiarlo a ogni passo
+  set<std::string, confronto_stringhe> lista6;
+  set<std::string, confronto_stringhe> lista7;
+  lista7.add("pippo");
+  lista7.add("pluto");
+  for (int i = 0; i < 3; i++)
+  {
+    lista6 += lista7;
+  }
+  assert(lista6.size() == 2);
+  lista7.alterna(lista6);
+  assert(lista7.is_empty());
+}
+
+/** 
+ * Nel seguente metodo vengono effettuati i test su filter_out, copia
+ * ed erase_if senza ricerche di duplicati
+ */
+void test_erase_if()
+{
+  set<int, confronto_interi, void, con_statistiche> lista1;
+  for (int i = 0; i < 100; i++)
+  {
+    lista1.add(i);
+  }
+  unsigned long confronti = lista1.stats().confronti;
+
+  // filter_out e copia accodano senza confrontare
+  set<int, confronto_interi, void, con_statistiche> lista2 = filter_out(lista1, int_pari());
+  assert(lista2.size() == 50 && lista2[49] == 98);
+  assert(lista2.stats().confronti == 0 && lista2.stats().ricerche == 0);
+  set<int, confronto_interi, void, con_statistiche> lista3(lista1);
+  assert(lista3.stats().confronti == 0 && lista1.stats().confronti == confronti);
+  assert(lista3 == lista1);
+
+  assert(erase_if(lista3, int_pari()) == 50);
+  assert(lista3.size() == 50 && lista3[0] == 1 && !lista3.cerca(2) && lista3.cerca(99));
+  assert(erase_if(lista3, int_pari()) == 0);
+
+  set<std::string, confronto_stringhe, std::hash<std::string> > lista4;
+  lista4.add("pippo");
+  lista4.add("pluto");
+  lista4.add("paperino");
+  assert(erase_if(lista4, string_dispari()) == 2);
+  assert(lista4.size() == 1 && !lista4.cerca("pippo") && lista4.cerca("paperino"));
+}
+
+/** 
+ * Nel seguente metodo vengono effettuati i test su salva, carica e
+ * mapped_set
+ */
+void test_mapped()
+{
+  const char *file = "test_mapped.bin";
+  set<int, confronto_interi, std::hash<int> > lista1;
+  for (int i = 0; i < 1000; i++)
+  {
+    lista1.add(i * 3);
+  }
+  lista1.remove(300);
+  salva(lista1, file);
+
+  {
+    mapped_set<int, confronto_interi, std::hash<int> > m(file);
+    assert(m.size() == lista1.size() && !m.is_empty());
+    assert(m.cerca(0) && m.cerca(2997) && !m.cerca(300) && !m.cerca(1));
+    assert(m[0] == 0 && m[100] == 303);
+    assert(std::equal(m.begin(), m.end(), lista1.begin()));
+
+    // senza Hash la tabella viene ignorata e la ricerca è lineare
+    mapped_set<int, confronto_interi> lineare(file);
+    assert(lineare.cerca(2997) && !lineare.cerca(300));
+
+    mapped_set<int, confronto_interi, std::hash<int> > spostata(std::move(m));
+    assert(spostata.size() == lista1.size() && m.size() == 0 && !m.cerca(0));
+  }
+
+  // intestazioni e tabelle danneggiate vengono rifiutate
+  set_dettagli::intestazione_file h;
+  std::FILE *f = std::fopen(file, "rb");
+  assert(f != nullptr && std::fread(&h, sizeof(h), 1, f) == 1);
+  std::fclose(f);
+  auto rifiutato = [file](const set_dettagli::intestazione_file &nuova, long pos, std::uint32_t voce, std::size_t voci) {
+    std::FILE *g = std::fopen(file, "r+b");
+    std::fwrite(&nuova, sizeof(nuova), 1, g);
+    std::fseek(g, pos, SEEK_SET);
+    for (std::size_t i = 0; i < voci; i++)
+      std::fwrite(&voce, sizeof(voce), 1, g);
+    std::fclose(g);
+    bool lanciata = false;
+    try
+    {
+      mapped_set<int, confronto_interi, std::hash<int> > m(file);
+    }
+    catch (std::runtime_error &)
+    {
+      lanciata = true;
+    }
+    return lanciata;
+  };
+  set_dettagli::intestazione_file rotta = h;
+  rotta.n = (~std::uint64_t(0)) / sizeof(int) + 2; // n * sizeof(int) torna piccolo
+  assert(rifiutato(rotta, 0, 0, 0));
+  rotta = h;
+  rotta.inizio_indice = ~std::uint64_t(0) - 63;
+  assert(rifiutato(rotta, 0, 0, 0));
+  assert(rifiutato(h, static_cast<long>(h.inizio_indice), 5000, 1));
+  assert(rifiutato(h, static_cast<long>(h.inizio_indice), 1, static_cast<std::size_t>(h.capacita)));
+  salva(lista1, file);
+
+  set<int, confronto_interi, std::hash<int> > lista2;
+  lista2.add(-1);
+  carica(lista2, file);
+  assert(lista2 == lista1 && !lista2.cerca(-1));
+  lista2.add(300);
+  assert(lista2.size() == lista1.size() + 1);
+
+  // set senza Hash: il file non ha tabella
+  set<int, confronto_interi> lista3;
+  salva(lista3, file);
+  mapped_set<int, confronto_interi, std::hash<int> > vuota(file);
+  assert(vuota.is_empty() && !vuota.cerca(0));
+
+  bool lanciata = false;
+  try
+  {
+    mapped_set<double, std::equal_to<double> > sbagliata(file);
+  }
+  catch (std::runtime_error &)
+  {
+    lanciata = true;
+  }
+  assert(lanciata);
+
+  // punto è banalmente copiabile, quindi anche una set di punti
+  set<punto, confronto_punti> punti;
+  for (int i = 0; i < 10; i++)
+  {
+    punti.add(punto(i, -i));
+  }
+  salva(punti, file);
+  {
+    mapped_set<punto, confronto_punti> m(file);
+    assert(m.size() == 10 && m.cerca(punto(3, -3)) && !m.cerca(punto(3, 3)));
+    assert(std::equal(m.begin(), m.end(), punti.begin()));
+  }
+  set<punto, confronto_punti> punti2;
+  carica(punti2, file);
+  assert(punti2 == punti);
+  std::remove(file);
+
+  lanciata = false;
+  try
+  {
+    mapped_set<int, confronto_interi> assente(file);
+  }
+  catch (std::runtime_error &)
+  {
+    lanciata = true;
+  }
+  assert(lanciata);
+}
+
+/** 
+ * Nel seguente metodo vengono effettuati i test su write_to, che deve
+ * produrre lo stesso testo dello stream elemento per elemento
+ */
+void test_write_to()
+{
+  set<int, confronto_interi, std::hash<int> > lista1;
+  std::ostringstream atteso;
+  for (int i = -50000; i < 50000; i += 7)
+  {
+    lista1.add(i * 3);
+    atteso << i * 3 << " ";
+  }
+  lista1.add(-2147483647 - 1);
+  atteso << -2147483647 - 1 << " ";
+  std::ostringstream scritto;
+  lista1.write_to(scritto);
+  assert(scritto.str() == atteso.str());
+  std::ostringstream stream;
+  stream << lista1;
+  assert(stream.str() == atteso.str());
+
+  std::ostringstream esadecimale, atteso_esadecimale;
+  esadecimale << std::hex;
+  atteso_esadecimale << std::hex;
+  for (set<int, confronto_interi, std::hash<int> >::const_iterator i = lista1.begin(); i != lista1.end(); ++i)
+    atteso_esadecimale << *i << ",";
+  lista1.write_to(esadecimale, ",");
+  assert(esadecimale.str() == atteso_esadecimale.str());
+
+  set<double, std::equal_to<double> > lista2;
+  lista2.add(0.5);
+  lista2.add(-1e300);
+  lista2.add(3.14159265358979);
+  std::ostringstream reali;
+  reali.precision(10);
+  lista2.write_to(reali, "\n");
+  assert(reali.str() == "0.5\n-1e+300\n3.141592654\n");
+
+  set<std::string, confronto_stringhe> lista3;
+  lista3.add("pippo");
+  lista3.add("pluto");
+  std::ostringstream stringhe;
+  lista3.write_to(stringhe, ", ");
+  assert(stringhe.str() == "pippo, pluto, ");
+
+  set<punto, confronto_punti> lista4;
+  lista4.add(punto(1, 2));
+  lista4.add(punto(3, 4));
+  std::ostringstream punti;
+  lista4.write_to(punti, ";");
+  assert(punti.str() == "(1,2);(3,4);");
+}
+
+/** 
+ * Nel seguente metodo vengono effettuati i test su int_set, confrontato
+ * con una set sugli stessi elementi
+ */
+void test_int_set()
+{
+  int_set lista1;
+  set<int, confronto_interi, std::hash<int> > riferimento1;
+  assert(lista1.is_empty() && lista1.begin() == lista1.end());
+  // un gruppo denso (bitmap), uno sparso (array) e valori negativi
+  for (int i = 0; i < 10000; i++)
+  {
+    lista1.add(i);
+    riferimento1.add(i);
+  }
+  for (int i = -3; i < 1000000; i += 997)
+  {
+    lista1.add(i);
+    riferimento1.add(i);
+  }
+  lista1.add(-2147483647 - 1);
+  riferimento1.add(-2147483647 - 1);
+  lista1.add(5);
+  assert(lista1.size() == riferimento1.size());
+  assert(lista1[0] == -2147483647 - 1 && lista1[1] == -3 && lista1[2] == 0);
+  assert(lista1[lista1.size() - 1] == 999988 && lista1[5002] == 5000);
+  for (set<int, confronto_interi, std::hash<int> >::const_iterator i = riferimento1.begin(); i != riferimento1.end(); ++i)
+    assert(lista1.cerca(*i));
+  assert(!lista1.cerca(10000) && !lista1.cerca(-1));
+
+  int precedente = 0;
+  unsigned int visitati = 0;
+  for (int_set::const_iterator i = lista1.begin(); i != lista1.end(); ++i, ++visitati)
+  {
+    assert(visitati == 0 || precedente < *i);
+    precedente = *i;
+  }
+  assert(visitati == lista1.size());
+
+  // rimuovendo il gruppo denso torna ad array
+  int_set lista2(lista1);
+  for (int i = 0; i < 9000; i++)
+    lista2.remove(i);
+  lista2.remove(123456789);
+  assert(lista2.size() == lista1.size() - 9000 && !lista2.cerca(8999) && lista2.cerca(9000));
+  for (int i = 0; i < 9000; i++)
+    lista2.add(i);
+  assert(lista2 == lista1);
+  lista2.remove(0);
+  assert(!(lista2 == lista1));
+
+  int_set lista3;
+  set<int, confronto_interi, std::hash<int> > riferimento3;
+  for (int i = 5000; i < 20000; i += 2)
+  {
+    lista3.add(i);
+    riferimento3.add(i);
+  }
+  lista3.add(-3);
+  riferimento3.add(-3);
+  int_set unione = lista1 + lista3;
+  int_set intersezione = lista1 - lista3;
+  set<int, confronto_interi, std::hash<int> > unione_attesa = riferimento1 + riferimento3;
+  set<int, confronto_interi, std::hash<int> > intersezione_attesa = riferimento1 - riferimento3;
+  assert(unione.size() == unione_attesa.size() && intersezione.size() == intersezione_attesa.size());
+  for (int_set::const_iterator i = unione.begin(); i != unione.end(); ++i)
+    assert(unione_attesa.cerca(*i));
+  for (int_set::const_iterator i = intersezione.begin(); i != intersezione.end(); ++i)
+    assert(intersezione_attesa.cerca(*i));
+  assert(lista1 + lista1 == lista1 && lista1 - lista1 == lista1);
+  assert((lista1 - int_set()).is_empty());
+
+  int_set pari = filter_out(lista1, int_pari());
+  assert(pari.size() == filter_out(riferimento1, int_pari()).size());
+  assert(pari.cerca(9998) && !pari.cerca(9999) && pari.cerca(-2147483647 - 1));
+
+  int v[] = {3, 1, 2, 3};
+  int_set lista4(v, v + 4);
+  std::ostringstream os;
+  os << lista4;
+  assert(os.str() == "1 2 3 ");
+  lista4.svuota();
+  assert(lista4.is_empty() && lista4 == int_set());
+}
+
+/** 
+ * Nel seguente metodo vengono effettuati i test sulle set con buffer
+ * interno di nodi
+ */
+void test_piccole()
+{
+  typedef set<int, confronto_interi, std::hash<int>, con_statistiche, 4> piccola;
+  piccola lista1;
+  for (int i = 1; i <= 4; i++)
+  {
+    lista1.add(i);
+  }
+  lista1.add(2);
+  assert(lista1.size() == 4 && lista1.cerca(4) && !lista1.cerca(5));
+  assert(lista1.stats().byte_in_uso == 0);
+
+  // copia, spostamento e scambio di set piccole non allocano
+  piccola lista2(lista1);
+  assert(lista2 == lista1 && lista2.stats().byte_in_uso == 0);
+  piccola lista3(std::move(lista2));
+  assert(lista2.is_empty() && lista3 == lista1 && lista3.stats().byte_in_uso == 0);
+  lista2.add(7);
+  std::swap(lista2, lista3);
+  assert(lista2 == lista1 && lista3.size() == 1 && lista3[0] == 7);
+  lista1.remove(1);
+  lista1.add(1);
+  assert(lista1.size() == 4 && lista1.stats().byte_in_uso == 0 && lista1[3] == 1);
+
+  // le espressioni il cui risultato sta nel buffer non allocano
+  piccola pa, pb, pc, pd;
+  for (int i = 1; i <= 3; i++)
+  {
+    pa.add(i);
+    pb.add(i + 1);
+  }
+  for (int i = 0; i < 10; i++)
+  {
+    pc.add(i);
+    pd.add(i + 8);
+  }
+  piccola unione = pa + pb;
+  piccola comuni = pc - pd;
+  assert(unione.size() == 4 && unione.cerca(4) && unione.stats().byte_in_uso == 0);
+  assert(comuni.size() == 2 && comuni.cerca(9) && comuni.stats().byte_in_uso == 0);
+
+  // oltre N i nodi escono dal buffer, l'ordine resta quello di inserimento
+  lista1.add(5);
+  assert(lista1.size() == 5 && lista1.stats().byte_in_uso > 0);
+  assert(lista1[0] == 2 && lista1[3] == 1 && lista1[4] == 5 && lista1.cerca(3) && lista1.cerca(5));
+  for (int i = 6; i <= 100; i++)
+  {
+    lista1.add(i);
+  }
+  assert(lista1.size() == 100 && lista1.cerca(100));
+  lista3 = lista1;
+  assert(lista3 == lista1);
+  lista2 = std::move(lista3);
+  assert(lista2 == lista1 && lista3.is_empty());
+  for (int i = 1; i <= 100; i++)
+  {
+    lista2.remove(i);
+  }
+  assert(lista2.is_empty());
+  lista2.add(42);
+  assert(lista2.size() == 1 && lista2.cerca(42));
+
+  // stringhe: gli elementi spostati tra i buffer restano validi
+  set<std::string, confronto_stringhe, std::hash<std::string>, senza_statistiche, 2> lista4, lista5;
+  lista4.add("pippo");
+  lista4.add("pluto");
+  lista5.add("paperino");
+  lista5.add("topolino");
+  lista5.add("minnie");
+  std::swap(lista4, lista5);
+  assert(lista4.size() == 3 && lista4[2] == "minnie" && lista5[1] == "pluto");
+  std::swap(lista5, lista4);
+  assert(lista5.size() == 3 && lista4.size() == 2 && lista4.cerca("pippo"));
+  set<std::string, confronto_stringhe, std::hash<std::string>, senza_statistiche, 2> lista6 = lista4 + lista5;
+  assert(lista6.size() == 5 && lista6.cerca("topolino"));
+  assert((lista6 - lista4).size() == 2);
+  lista6 -= lista4;
+  assert(lista6 == lista4);
+
+  const char *c[4] = {"qui", "quo", "qua", nullptr};
+  try
+  {
+    lista4.insert(c, c + 4);
+    assert(false);
+  }
+  catch (const std::logic_error &)
+  {
+  }
+  assert(lista4.size() == 2 && !lista4.cerca("qui"));
+  lista4.insert(c, c + 3);
+  assert(lista4.size() == 5 && lista4.cerca("qua"));
+}
+
+/** 
+ * Nel seguente metodo vengono effettuati i test sugli hash memorizzati
+ * nei nodi e sulle stringhe internate
+ */
+void test_internate()
+{
+  // nel buffer interno le ricerche scartano i nodi con hash diverso
+  set<std::string, confronto_stringhe, std::hash<std::string>, con_statistiche, 8> lista1;
+  lista1.add("https://esempio.it/percorso/lungo/pagina-1");
+  lista1.add("https://esempio.it/percorso/lungo/pagina-2");
+  lista1.add("https://esempio.it/percorso/lungo/pagina-3");
+  unsigned long confronti = lista1.stats().confronti;
+  assert(!lista1.cerca("https://esempio.it/percorso/lungo/pagina-4"));
+  assert(lista1.cerca("https://esempio.it/percorso/lungo/pagina-2"));
+  assert(lista1.stats().confronti == confronti + 1);
+
+  // le operazioni tra set riusano gli hash dei nodi
+  set<std::string, confronto_stringhe, std::hash<std::string> > lista2, lista3;
+  for (int i = 0; i < 100; i++)
+  {
+    std::ostringstream os;
+    os << "https://esempio.it/" << i;
+    lista2.add(os.str());
+    if (i % 2 == 0)
+      lista3.add(os.str());
+  }
+  assert(differenza(lista2, lista3).size() == 50);
+  assert(differenza(lista2, lista3).cerca("https://esempio.it/99"));
+  lista3 += lista2;
+  assert(lista3 == lista2);
+  lista3.togli(lista2);
+  assert(lista3.is_empty());
+
+  tabella_stringhe tabella;
+  stringa_internata a = tabella.interna("https://esempio.it/a");
+  stringa_internata b = tabella.interna(std::string("https://esempio.it/a"));
+  stringa_internata c = tabella.interna("https://esempio.it/b");
+  assert(a == b && a != c && a.c_str() == b.c_str() && tabella.size() == 2);
+  assert(a.size() == 20 && a.str() == "https://esempio.it/a" && a.hash() == b.hash());
+  assert(tabella.interna("") == stringa_internata() && stringa_internata().size() == 0);
+
+  set<stringa_internata, confronto_internate, hash_internate> lista4, lista5;
+  for (int i = 0; i < 1000; i++)
+  {
+    std::ostringstream os;
+    os << "https://esempio.it/percorso/" << i % 100;
+    lista4.add(tabella.interna(os.str()));
+    if (i % 3 == 0)
+      lista5.add(tabella.interna(os.str()));
+  }
+  assert(tabella.size() == 102 && lista4.size() == 100 && lista5.size() == 100);
+  assert(lista4 == lista5 && lista4.cerca(tabella.interna("https://esempio.it/percorso/42")));
+  std::ostringstream os;
+  os << lista4[0];
+  assert(os.str() == "https://esempio.it/percorso/0");
+}
+
+void test_impronta()
+{
+  typedef set<int, confronto_interi, std::hash<int> > set_int;
+  // senza Hash std::hash<set> è disabilitato
+  static_assert(std::is_default_constructible<std::hash<set_int> >::value, "hash di set con Hash");
+  static_assert(!std::is_default_constructible<std::hash<set<int, confronto_interi> > >::value,
+                "hash di set senza Hash");
+  set_int lista1, lista2;
+  for (int i = 0; i < 1000; i++)
+  {
+    lista1.add(i);
+    lista2.add(999 - i);
+  }
+  assert(lista1.impronta() == lista2.impronta() && lista1 == lista2);
+  lista2.remove(500);
+  assert(lista1.impronta() != lista2.impronta() && !(lista1 == lista2));
+  lista2.add(500);
+  assert(lista1.impronta() == lista2.impronta() && lista1 == lista2);
+  lista2.remove(0);
+  lista2.add(1000);
+  assert(lista1.size() == lista2.size() && !(lista1 == lista2));
+  lista1.svuota();
+  lista2.svuota();
+  assert(lista1.impronta() == set_int().impronta() && lista1 == lista2);
+
+  // l'impronta segue gli elementi anche nel buffer interno e negli spostamenti
+  set<int, confronto_interi, std::hash<int>, senza_statistiche, 4> piccola1, piccola2;
+  piccola1.add(1);
+  piccola1.add(2);
+  piccola2.add(2);
+  piccola2.add(1);
+  assert(piccola1.impronta() == piccola2.impronta() && piccola1 == piccola2);
+  piccola2.add(3);
+  std::swap(piccola1, piccola2);
+  assert(piccola1.size() == 3 && !(piccola1 == piccola2));
+  piccola2.add(3);
+  assert(piccola1.impronta() == piccola2.impronta() && piccola1 == piccola2);
+
+  // set come elementi di una set e come chiavi di contenitori hash
+  set<set_int, std::equal_to<set_int>, std::hash<set_int> > insiemi;
+  set_int a, b;
+  a.add(1);
+  a.add(2);
+  b.add(2);
+  b.add(1);
+  insiemi.add(a);
+  insiemi.add(b);
+  insiemi.add(set_int());
+  assert(insiemi.size() == 2 && insiemi.cerca(b));
+  b.add(3);
+  assert(!insiemi.cerca(b));
+  std::unordered_set<set_int, std::hash<set_int>, std::equal_to<set_int> > chiavi;
+  chiavi.insert(a);
+  assert(chiavi.count(b) == 0);
+  b.remove(3);
+  assert(chiavi.count(b) == 1);
+}
+
+void test_cow()
+{
+  // la copia di una set accoda senza confronti
+  set<int, confronto_interi, std::hash<int>, con_statistiche> lista1;
+  for (int i = 0; i < 1000; i++)
+    lista1.add(i);
+  set<int, confronto_interi, std::hash<int>, con_statistiche> lista2(lista1);
+  assert(lista2.stats().confronti == 0 && lista2 == lista1);
+
+  typedef cow_set<int, confronto_interi, std::hash<int> > cow;
+  set<int, confronto_interi, std::hash<int> > base;
+  for (int i = 0; i < 100; i++)
+    base.add(i);
+  cow a(base);
+  cow b(a), c;
+  c = b;
+  assert(a.condivisa_con_altre() && &a.leggi() == &c.leggi() && a == c);
+  // aggiungere un valore presente o togliere uno assente non copia
+  b.add(5);
+  b.remove(500);
+  assert(&b.leggi() == &a.leggi());
+  b.add(100);
+  assert(&b.leggi() != &a.leggi() && !b.condivisa_con_altre());
+  assert(b.size() == 101 && a.size() == 100 && c.size() == 100 && !(a == b));
+  c.modifica([](set<int, confronto_interi, std::hash<int> > &s) { s.remove(0); s.remove(1); });
+  assert(c.size() == 98 && a.size() == 100 && !a.condivisa_con_altre());
+  a.remove(0);
+  a.remove(1);
+  assert(a == c && !a.cerca(1) && a.cerca(2));
+  int somma = 0;
+  for (cow::const_iterator it = c.begin(); it != c.end(); ++it)
+    somma += *it;
+  assert(somma == 4950 - 1);
+  cow d(c);
+  d.svuota();
+  assert(d.is_empty() && c.size() == 98);
+
+  // copie usate da thread diversi
+  std::vector<std::thread> thread;
+  std::atomic<int> errori(0);
+  for (int t = 0; t < 4; t++)
+    thread.push_back(std::thread([&a, &errori, t]() {
+      for (int i = 0; i < 200; i++)
+      {
+        cow mia(a);
+        mia.add(1000 + t);
+        if (mia.size() != 99 || !mia.cerca(50) || a.cerca(1000 + t))
+          errori++;
+      }
+    }));
+  for (std::size_t t = 0; t < thread.size(); t++)
+    thread[t].join();
+  assert(errori == 0 && a.size() == 98);
+  std::ostringstream os;
+  os << cow(std::move(base));
+  assert(os.str().substr(0, 6) == "0 1 2 ");
+}
+
+/**
+ * @brief Hash con molte collisioni, per le catene di persistent_set
+ */
+struct hash_modulo_sette
+{
+  std::size_t operator()(int v) const
+  {
+    return static_cast<std::size_t>(v % 7);
+  }
+};
+
+template <typename H>
+void test_persistente_con()
+{
+  typedef persistent_set<int, confronto_interi, H> pset;
+  // versioni successive confrontate con una set modificata sul posto
+  std::vector<pset> versioni(1, pset());
+  set<int, confronto_interi, std::hash<int> > attesa;
+  unsigned long x = 12345;
+  for (int i = 0; i < 3000; i++)
+  {
+    x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+    int v = static_cast<int>((x >> 33) % 1000);
+    if ((x >> 20) % 3 == 0)
+    {
+      versioni.push_back(versioni.back().remove(v));
+      attesa.remove(v);
+    }
+    else
+    {
+      versioni.push_back(versioni.back().add(v));
+      attesa.add(v);
+    }
+    assert(versioni.back().size() == attesa.size());
+  }
+  const pset &ultima = versioni.back();
+  for (int v = 0; v < 1000; v++)
+    assert(ultima.cerca(v) == attesa.cerca(v));
+  unsigned int contati = 0;
+  for (typename pset::const_iterator it = ultima.begin(); it != ultima.end(); ++it, ++contati)
+    assert(attesa.cerca(*it));
+  assert(contati == ultima.size());
+
+  // le versioni vecchie non cambiano
+  assert(versioni[0].is_empty() && versioni[1].size() == 1);
+  pset a = versioni[1500];
+  unsigned int prima = a.size();
+  pset b = a.add(5000).remove(5000);
+  assert(a.size() == prima && b == a && !a.cerca(5000));
+
+  // la forma non dipende dall'ordine di inserimento e rimozione
+  pset c, d;
+  for (int i = 0; i < 1000; i++)
+  {
+    if (i < 500)
+      c = c.add(i);
+    d = d.add(999 - i);
+  }
+  for (int i = 500; i < 1000; i++)
+    d = d.remove(i);
+  assert(c == d && c.size() == 500 && !(c == d.remove(3)));
+
+  pset pari = filter_out(c, [](int v) { return v % 2 == 0; });
+  assert(pari.size() == 250 && pari.cerca(0) && !pari.cerca(1));
+  assert(filter_out(c, [](int) { return true; }) == c);
+  assert(filter_out(c, [](int) { return false; }).is_empty());
+
+  pset e;
+  for (int i = 250; i < 750; i++)
+    e = e.add(i);
+  pset u = c + e, n = c - e;
+  assert(u.size() == 750 && u.cerca(0) && u.cerca(749) && !u.cerca(750));
+  assert(n.size() == 250 && n.cerca(250) && n.cerca(499) && !n.cerca(500) && !n.cerca(249));
+  assert(c + c == c && c - c == c && (c + pset()) == c && (c - pset()).is_empty());
+  assert((pari + c) == c && (pari - c) == pari);
+  std::ostringstream os;
+  os << pset().add(7);
+  assert(os.str() == "7 ");
+}
+
+void test_persistente()
+{
+  test_persistente_con<std::hash<int> >();
+  test_persistente_con<hash_modulo_sette>();
+
+  // versioni lette e modificate da più thread
+  typedef persistent_set<int, confronto_interi, std::hash<int> > pset;
+  std::vector<int> valori;
+  for (int i = 0; i < 1000; i++)
+    valori.push_back(i);
+  const pset base(valori.begin(), valori.end());
+  std::vector<std::thread> thread;
+  std::atomic<int> errori(0);
+  for (int t = 0; t < 4; t++)
+    thread.push_back(std::thread([&base, &errori, t]() {
+      pset mia = base;
+      for (int i = 0; i < 500; i++)
+        mia = mia.remove(i * 2 + t % 2).add(-1 - i);
+      if (mia.size() != 1000 || base.size() != 1000 || !base.cerca(0))
+        errori++;
+    }));
+  for (std::size_t t = 0; t < thread.size(); t++)
+    thread[t].join();
+  assert(errori == 0);
+}
+
+int main()
+{
+  test_int();
+  test_string();
+  test_custom();
+  test_hash();
+  test_ordered();
+  test_arena();
+  test_move();
+  test_insert();
+  test_stats();
+  test_packed();
+  test_parallelo();
+  test_concurrent();
+  test_snapshot();
+  test_prefiltro();
+  test_batch();
+  test_espressioni();
+  test_composti();
+  test_erase_if();
+  test_mapped();
+  test_write_to();
+  test_int_set();
+  test_piccole();
+  test_internate();
+  test_impronta();
+  test_cow();
+  test_persistente();
+
+  return 0;
+}
@@ -0,0 +1,418 @@
+#ifndef MAPPED_SET_H
+#define MAPPED_SET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "set.h"
+
+namespace set_dettagli
+{
+  /**
+    @brief Intestazione di un file di set
+
+    Il file contiene l'intestazione, gli elementi nell'ordine di
+    inserimento e, se la set aveva un funtore Hash, una tabella di
+    posizioni (indirizzamento aperto, 0 = slot libero, altrimenti
+    posizione dell'elemento + 1) costruita con lo stesso hash mescolato
+    dell'indice di set. Elementi e tabella iniziano a multipli di 64 byte.
+    I numeri sono scritti nell'ordine dei byte della macchina: un file
+    letto su un'architettura diversa viene rifiutato dal controllo della
+    versione.
+  */
+  struct intestazione_file
+  {
+    char magia[8];                 ///< "SETFILE" e terminatore
+    std::uint32_t versione;        ///< versione del formato
+    std::uint32_t dim_elemento;    ///< sizeof(T) di chi ha scritto il file
+    std::uint64_t n;               ///< numero di elementi
+    std::uint64_t capacita;        ///< slot della tabella, 0 se assente
+    std::uint64_t inizio_elementi; ///< posizione degli elementi nel file
+    std::uint64_t inizio_indice;   ///< posizione della tabella nel file
+  };
+
+  const char magia_file[8] = "SETFILE";
+  const std::uint32_t versione_file = 1;
+
+  /// allinea una posizione nel file a 64 byte
+  inline std::uint64_t allinea_file(std::uint64_t p)
+  {
+    return (p + 63) & ~std::uint64_t(63);
+  }
+
+  /**
+   * @brief Costruisce la tabella delle posizioni per il file
+   * Senza Hash la tabella resta vuota.
+   */
+  template <typename T, typename Hash>
+  struct tabella_file
+  {
+    template <typename It>
+    static void costruisci(It b, std::uint64_t n, std::vector<std::uint32_t> &tabella)
+    {
+      std::size_t c = 16;
+      while (c * 3 < n * 4)
+        c *= 2;
+      tabella.assign(c, 0);
+      Hash hash;
+      for (std::uint32_t i = 0; i < n; ++i, ++b)
+      {
+        std::size_t j = mescola(hash(*b)) & (c - 1);
+        while (tabella[j] != 0)
+          j = (j + 1) & (c - 1);
+        tabella[j] = i + 1;
+      }
+    }
+  };
+
+  template <typename T>
+  struct tabella_file<T, void>
+  {
+    template <typename It>
+    static void costruisci(It, std::uint64_t, std::vector<std::uint32_t> &tabella)
+    {
+      tabella.clear();
+    }
+  };
+}
+
+/**
+ * @brief Salva una set in un file binario
+ * Scrive gli elementi così come sono in memoria, quindi T deve essere
+ * banalmente copiabile. Il file può essere riaperto con mapped_set o
+ * ricaricato in una set con carica.
+ * @tparam T elemento di tipo T
+ * @tparam Eql funtore di uguaglianza
+ * @tparam Hash funtore di hash (void se assente)
+ * @tparam Stats politica delle statistiche
+ * @tparam N nodi nel buffer interno della set
+ * @param s set da salvare
+ * @param file percorso del file, sovrascritto se esiste
+ * @throw std::runtime_error se il file non può essere scritto
+ */
+template <typename T, typename Eql, typename Hash, typename Stats, std::size_t N>
+void salva(const set<T, Eql, Hash, Stats, N> &s, const char *file)
+{
+  static_assert(std::is_trivially_copyable<T>::value, "salva richiede un tipo banalmente copiabile");
+  assert(s.size() < 0xffffffffu);
+
+  std::vector<std::uint32_t> tabella;
+  set_dettagli::tabella_file<T, Hash>::costruisci(s.begin(), s.size(), tabella);
+
+  set_dettagli::intestazione_file h;
+  std::memset(&h, 0, sizeof(h));
+  std::memcpy(h.magia, set_dettagli::magia_file, sizeof(h.magia));
+  h.versione = set_dettagli::versione_file;
+  h.dim_elemento = sizeof(T);
+  h.n = s.size();
+  h.capacita = tabella.size();
+  h.inizio_elementi = set_dettagli::allinea_file(sizeof(h));
+  h.inizio_indice = set_dettagli::allinea_file(h.inizio_elementi + h.n * sizeof(T));
+
+  std::ofstream os(file, std::ios::binary | std::ios::trunc);
+  const char zeri[64] = {0};
+  os.write(reinterpret_cast<const char *>(&h), sizeof(h));
+  os.write(zeri, h.inizio_elementi - sizeof(h));
+  for (typename set<T, Eql, Hash, Stats, N>::const_iterator i = s.begin(), e = s.end(); i != e; ++i)
+    os.write(reinterpret_cast<const char *>(&*i), sizeof(T));
+  if (!tabella.empty())
+  {
+    os.write(zeri, h.inizio_indice - h.inizio_elementi - h.n * sizeof(T));
+    os.write(reinterpret_cast<const char *>(&tabella[0]), tabella.size() * sizeof(std::uint32_t));
+  }
+  os.close();
+  if (!os)
+    throw std::runtime_error(std::string("impossibile scrivere ") + file);
+}
+
+/**
+  @brief classe mapped_set
+
+  Set in sola lettura aperta da un file scritto con salva, mappato in
+  memoria con mmap: l'apertura non copia né reinserisce gli elementi,
+  che vengono letti dal file solo quando servono. Gli elementi
+  mantengono l'ordine di inserimento della set salvata.
+  Se il file contiene la tabella delle posizioni e Hash non è void la
+  ricerca è O(1) attesa, altrimenti scorre gli elementi con Eql. La
+  tabella è valida solo se Hash dà gli stessi valori del programma che
+  ha scritto il file.
+  T deve essere banalmente copiabile.
+*/
+template <typename T, typename Eql, typename Hash = void>
+class mapped_set
+{
+  static_assert(std::is_trivially_copyable<T>::value, "mapped_set richiede un tipo banalmente copiabile");
+
+  void *_mappa;                 ///< inizio del file in memoria
+  std::size_t _byte;            ///< dimensione della mappatura
+  const T *_elementi;           ///< elementi nel file
+  std::size_t _n;               ///< numero di elementi
+  const std::uint32_t *_tabella; ///< tabella delle posizioni, nullptr se non usata
+  std::size_t _capacita;        ///< slot della tabella
+  Eql _equals;                  ///< funtore per l'uguaglianza tra elementi T
+
+  mapped_set(const mapped_set &other);
+  mapped_set &operator=(const mapped_set &other);
+
+  /**
+   * @brief Posizione di un valore
+   * @return indice dell'elemento uguale a v, _n se non presente
+   */
+  std::size_t posizione(const T &v) const
+  {
+    return posizione(v, std::integral_constant<bool, !std::is_void<Hash>::value>());
+  }
+
+  std::size_t posizione(const T &v, std::true_type) const
+  {
+    if (_tabella == nullptr)
+      return posizione(v, std::false_type());
+    std::size_t maschera = _capacita - 1;
+    for (std::size_t j = set_dettagli::mescola(Hash()(v)) & maschera;
+         _tabella[j] != 0; j = (j + 1) & maschera)
+      if (_equals(_elementi[_tabella[j] - 1], v))
+        return _tabella[j] - 1;
+    return _n;
+  }
+
+  std::size_t posizione(const T &v, std::false_type) const
+  {
+    for (std::size_t i = 0; i < _n; ++i)
+      if (_equals(_elementi[i], v))
+        return i;
+    return _n;
+  }
+
+  /**
+   * @brief Controlla che una regione descritta dall'intestazione stia nel file
+   * I valori vengono dal file: il confronto usa una divisione, così non può
+   * andare in overflow.
+   * @param inizio posizione della regione
+   * @param numero voci della regione
+   * @param dim byte di ogni voce
+   */
+  bool nel_file(std::uint64_t inizio, std::uint64_t numero, std::size_t dim) const
+  {
+    return inizio <= _byte && numero <= (_byte - inizio) / dim;
+  }
+
+  /**
+   * @brief Controlla la tabella delle posizioni
+   * Ogni voce deve indicare un elemento del file e almeno uno slot deve
+   * essere libero, altrimenti le ricerche leggerebbero fuori dagli
+   * elementi o non terminerebbero. Costa una lettura sequenziale della
+   * tabella.
+   */
+  bool tabella_valida() const
+  {
+    bool libero = false;
+    for (std::size_t j = 0; j < _capacita; ++j)
+    {
+      if (_tabella[j] > _n)
+        return false;
+      libero = libero || _tabella[j] == 0;
+    }
+    return libero;
+  }
+
+  // Rifiuta un file non valido liberando la mappatura
+  void rifiuta(const char *file, const char *motivo)
+  {
+    chiudi();
+    throw std::runtime_error(std::string(file) + ": " + motivo);
+  }
+
+  void chiudi()
+  {
+    if (_mappa != nullptr)
+      munmap(_mappa, _byte);
+    _mappa = nullptr;
+    _byte = 0;
+    _elementi = nullptr;
+    _n = 0;
+    _tabella = nullptr;
+    _capacita = 0;
+  }
+
+public:
+  /**
+   Gli iteratori scorrono gli elementi nel file, in ordine di
+   inserimento, e sono solo in lettura.
+   */
+  typedef const T *const_iterator;
+
+  /**
+   * @brief Apre un file scritto con salva
+   * @param file percorso del file
+   * @throw std::runtime_error se il file non esiste o non è valido per T
+   */
+  explicit mapped_set(const char *file)
+      : _mappa(nullptr), _byte(0), _elementi(nullptr), _n(0), _tabella(nullptr), _capacita(0)
+  {
+    int fd = open(file, O_RDONLY);
+    if (fd < 0)
+      throw std::runtime_error(std::string("impossibile aprire ") + file);
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(set_dettagli::intestazione_file))
+    {
+      ::close(fd);
+      throw std::runtime_error(std::string(file) + ": file troppo corto");
+    }
+    _byte = static_cast<std::size_t>(st.st_size);
+    void *m = mmap(nullptr, _byte, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (m == MAP_FAILED)
+      throw std::runtime_error(std::string("impossibile mappare ") + file);
+    _mappa = m;
+
+    const set_dettagli::intestazione_file *h = static_cast<const set_dettagli::intestazione_file *>(_mappa);
+    if (std::memcmp(h->magia, set_dettagli::magia_file, sizeof(h->magia)) != 0)
+      rifiuta(file, "non è un file di set");
+    if (h->versione != set_dettagli::versione_file)
+      rifiuta(file, "versione del formato non supportata");
+    if (h->dim_elemento != sizeof(T))
+      rifiuta(file, "dimensione degli elementi diversa");
+    if (h->inizio_elementi % 64 != 0 || !nel_file(h->inizio_elementi, h->n, sizeof(T)) ||
+        (h->capacita != 0 && (h->inizio_indice % 64 != 0 || (h->capacita & (h->capacita - 1)) != 0 ||
+                              !nel_file(h->inizio_indice, h->capacita, sizeof(std::uint32_t)))))
+      rifiuta(file, "file troncato o danneggiato");
+
+    const char *base = static_cast<const char *>(_mappa);
+    _elementi = reinterpret_cast<const T *>(base + h->inizio_elementi);
+    _n = static_cast<std::size_t>(h->n);
+    if (h->capacita != 0 && !std::is_void<Hash>::value)
+    {
+      _tabella = reinterpret_cast<const std::uint32_t *>(base + h->inizio_indice);
+      _capacita = static_cast<std::size_t>(h->capacita);
+      if (!tabella_valida())
+        rifiuta(file, "tabella delle posizioni danneggiata");
+    }
+  }
+
+  /**
+   * @brief Move constructor
+   * @param other mapped_set da cui prendere la mappatura, che resta vuota
+   */
+  mapped_set(mapped_set &&other) noexcept
+      : _mappa(other._mappa), _byte(other._byte), _elementi(other._elementi), _n(other._n),
+        _tabella(other._tabella), _capacita(other._capacita), _equals(other._equals)
+  {
+    other._mappa = nullptr;
+    other.chiudi();
+  }
+
+  /**
+    Distruttore: rilascia la mappatura
+  */
+  ~mapped_set()
+  {
+    chiudi();
+  }
+
+  /**
+   * @brief Funzione per vedere se l'insieme è vuoto
+   * @return true se l'insieme è vuoto
+   * @return false altrimenti
+   */
+  bool is_empty() const
+  {
+    return _n == 0;
+  }
+
+  /**
+   * @brief Dimensione
+   * @return il numero di elementi nel file
+   */
+  unsigned int size() const
+  {
+    return static_cast<unsigned int>(_n);
+  }
+
+  /**
+   * @brief Cerca un valore
+   * @param valore valore da cercare
+   * @return true se il valore è presente
+   * @return false altrimenti
+   */
+  bool cerca(const T &valore) const
+  {
+    return posizione(valore) != _n;
+  }
+
+  // Ritorna l'iteratore all'inizio della sequenza dati
+  const_iterator begin() const
+  {
+    return _elementi;
+  }
+
+  // Ritorna l'iteratore alla fine della sequenza dati
+  const_iterator end() const
+  {
+    return _elementi + _n;
+  }
+
+  /**
+   * @brief Operatore[]
+   * @param i posizione dell'elemento
+   * @return elemento in posizione i
+   */
+  const T &operator[](int i) const
+  {
+    assert(i >= 0 && static_cast<std::size_t>(i) < _n);
+    return _elementi[i];
+  }
+
+  /**
+   * @brief Copia gli elementi in una set
+   * Gli elementi del file sono distinti, quindi vengono accodati senza
+   * ricerche. Il contenuto precedente di s viene sostituito.
+   * @param s set da riempire
+   */
+  template <typename Stats, std::size_t N>
+  void copia_in(set<T, Eql, Hash, Stats, N> &s) const
+  {
+    set<T, Eql, Hash, Stats, N> tmp(s._pool.sorgente());
+    tmp.riserva_indice(_n);
+    tmp.riserva_nodi(_n);
+    tmp.accoda_sequenza(begin(), end(), _n);
+    s.scambia(tmp);
+  }
+
+  /**
+   * @brief Funzione di stream
+   * Stampa gli elementi separati da uno spazio
+   * @param os stream di output
+   * @param s insieme da spedire sullo stream
+   * @return lo stream di output
+   */
+  friend std::ostream &operator<<(std::ostream &os, const mapped_set &s)
+  {
+    for (const_iterator i = s.begin(); i != s.end(); ++i)
+      os << *i << " ";
+    return os;
+  }
+};
+
+/**
+ * @brief Carica in una set un file scritto con salva
+ * Il file viene mappato e gli elementi accodati senza ricerche.
+ * @param s set da riempire, il contenuto precedente viene sostituito
+ * @param file percorso del file
+ * @throw std::runtime_error se il file non esiste o non è valido per T
+ */
+template <typename T, typename Eql, typename Hash, typename Stats, std::size_t N>
+void carica(set<T, Eql, Hash, Stats, N> &s, const char *file)
+{
+  mapped_set<T, Eql, Hash>(file).copia_in(s);
+}
+
+#endif
@@ -0,0 +1,299 @@
+#ifndef ORDERED_SET_H
+#define ORDERED_SET_H
+
+#include <ostream>
+#include <cassert>
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <vector>
+#include <cstddef>
+
+/**
+  @brief classe ordered_set
+
+  La classe implementa un insieme di elementi T mantenuti ordinati.
+  L'ordine è dato dal funtore Less che prende due elementi a e b e
+  ritorna vero se a precede b. Due elementi sono considerati uguali
+  quando nessuno dei due precede l'altro.
+  Gli elementi sono memorizzati in un vettore ordinato: la ricerca è
+  binaria (O(log n)), l'accesso posizionale è O(1), e unione e
+  intersezione di due ordered_set sono una singola fusione lineare.
+  L'inserimento singolo sposta gli elementi successivi (O(n)); per
+  caricare molti elementi conviene il costruttore da iteratori, che
+  ordina una volta sola.
+*/
+template <typename T, typename Less>
+class ordered_set
+{
+  std::vector<T> _dati; ///< elementi ordinati secondo Less, senza duplicati
+  Less _less;           ///< funtore d'ordine tra elementi T
+
+  /**
+   * @brief Verifica se due elementi sono equivalenti secondo Less
+   * @param a primo elemento
+   * @param b secondo elemento
+   * @return true se nessuno dei due precede l'altro
+   */
+  bool equivalenti(const T &a, const T &b) const
+  {
+    return !_less(a, b) && !_less(b, a);
+  }
+
+public:
+  /**
+   Gli iteratori scorrono gli elementi in ordine crescente e sono
+   solo in lettura.
+   */
+  typedef typename std::vector<T>::const_iterator const_iterator;
+
+  /**
+   * @brief Costruttore di default
+   * @post size() == 0
+   */
+  ordered_set() {}
+
+  /**
+   * @brief Costruttore iteratore
+   * Costruttore che crea un ordered_set riempito con dati presi da una
+   * sequenza identificata da un iteratore di inizio e uno di fine.
+   * Gli elementi vengono ordinati e i duplicati scartati in O(n log n).
+   * @param b iteratore di inizio
+   * @param e iteratore di fine
+   */
+  template <typename Q>
+  ordered_set(Q b, Q e)
+  {
+    for (; b != e; ++b)
+      _dati.push_back(static_cast<T>(*b));
+    std::stable_sort(_dati.begin(), _dati.end(), _less);
+    _dati.erase(std::unique(_dati.begin(), _dati.end(), uguali(_less)), _dati.end());
+  }
+
+  /**
+   * @brief Svuota l'insieme
+   * @post size() == 0
+   */
+  void svuota()
+  {
+    _dati.clear();
+  }
+
+  /**
+   * @brief Funzione per vedere se l'insieme è vuoto
+   * @return true se l'insieme è vuoto
+   * @return false altrimenti
+   */
+  bool is_empty() const
+  {
+    return _dati.empty();
+  }
+
+  /**
+   * @brief Dimensione
+   * @return il numero di elementi nell'insieme
+   */
+  unsigned int size() const
+  {
+    return static_cast<unsigned int>(_dati.size());
+  }
+
+  /**
+   * @brief Aggiunge un elemento mantenendo l'ordine
+   * Se un elemento equivalente è già presente l'insieme non cambia.
+   * @param v valore da inserire
+   */
+  void add(const T &v)
+  {
+    typename std::vector<T>::iterator i = std::lower_bound(_dati.begin(), _dati.end(), v, _less);
+    if (i != _dati.end() && !_less(v, *i))
+      return;
+    _dati.insert(i, v);
+  }
+
+  /**
+   * @brief Rimuovi
+   * Rimuove dall'insieme l'elemento equivalente a v, se presente
+   * @param v valore da rimuovere
+   */
+  void remove(const T &v)
+  {
+    typename std::vector<T>::iterator i = std::lower_bound(_dati.begin(), _dati.end(), v, _less);
+    if (i != _dati.end() && !_less(v, *i))
+      _dati.erase(i);
+  }
+
+  /**
+   * @brief Cerca un valore con una ricerca binaria
+   * @param valore valore da cercare
+   * @return true se il valore è presente
+   * @return false altrimenti
+   */
+  bool cerca(const T &valore) const
+  {
+    const_iterator i = lower_bound(valore);
+    return i != end() && !_less(valore, *i);
+  }
+
+  /**
+   * @brief Primo elemento non minore di v
+   * @param v valore di riferimento
+   * @return iteratore al primo elemento e con !Less(e, v), end() se non esiste
+   */
+  const_iterator lower_bound(const T &v) const
+  {
+    return std::lower_bound(_dati.begin(), _dati.end(), v, _less);
+  }
+
+  /**
+   * @brief Primo elemento maggiore di v
+   * @param v valore di riferimento
+   * @return iteratore al primo elemento e con Less(v, e), end() se non esiste
+   */
+  const_iterator upper_bound(const T &v) const
+  {
+    return std::upper_bound(_dati.begin(), _dati.end(), v, _less);
+  }
+
+  /**
+   * @brief Intervallo di elementi
+   * Ritorna gli elementi compresi nell'intervallo semiaperto [da, a)
+   * @param da estremo inferiore (incluso)
+   * @param a estremo superiore (escluso)
+   * @return coppia di iteratori di inizio e fine dell'intervallo
+   */
+  std::pair<const_iterator, const_iterator> range(const T &da, const T &a) const
+  {
+    const_iterator b = lower_bound(da);
+    const_iterator e = lower_bound(a);
+    if (e < b)
+      e = b;
+    return std::make_pair(b, e);
+  }
+
+  // Ritorna l'iteratore all'inizio della sequenza dati
+  const_iterator begin() const
+  {
+    return _dati.begin();
+  }
+
+  // Ritorna l'iteratore alla fine della sequenza dati
+  const_iterator end() const
+  {
+    return _dati.end();
+  }
+
+  /**
+   * @brief Operatore[]
+   * Accesso in sola lettura all'i-esimo elemento in ordine crescente
+   * @param i posizione dell'elemento
+   * @return elemento in posizione i
+   */
+  const T &operator[](int i) const
+  {
+    assert(i >= 0 && static_cast<unsigned int>(i) < size());
+    return _dati[i];
+  }
+
+  /**
+   * @brief Operatore di uguaglianza
+   * Essendo entrambi ordinati, il confronto è un'unica scansione
+   * @param other insieme da comparare
+   * @return true se i due insiemi contengono elementi equivalenti
+   * @return false altrimenti
+   */
+  bool operator==(const ordered_set &other) const
+  {
+    if (size() != other.size())
+      return false;
+    for (unsigned int i = 0; i < size(); ++i)
+      if (!equivalenti(_dati[i], other._dati[i]))
+        return false;
+    return true;
+  }
+
+  /**
+   * @brief Funzione di stream
+   * Stampa gli elementi in ordine crescente separati da uno spazio
+   * @param os stream di output
+   * @param s insieme da spedire sullo stream
+   * @return lo stream di output
+   */
+  friend std::ostream &operator<<(std::ostream &os, const ordered_set &s)
+  {
+    for (const_iterator i = s.begin(); i != s.end(); ++i)
+      os << *i << " ";
+    return os;
+  }
+
+  /**
+   * @brief Unione per fusione
+   * Funzione GLOBALE che fonde due insiemi ordinati in un'unica passata
+   * @param s1 primo insieme
+   * @param s2 secondo insieme
+   * @return insieme con gli elementi di entrambi, senza duplicati
+   */
+  friend ordered_set operator+(const ordered_set &s1, const ordered_set &s2)
+  {
+    ordered_set s3;
+    s3._dati.reserve(s1._dati.size() + s2._dati.size());
+    std::set_union(s1._dati.begin(), s1._dati.end(), s2._dati.begin(), s2._dati.end(),
+                   std::back_inserter(s3._dati), s1._less);
+    return s3;
+  }
+
+  /**
+   * @brief Intersezione per fusione
+   * Funzione GLOBALE che ritorna gli elementi comuni ai due insiemi
+   * ordinati in un'unica passata
+   * @param s1 primo insieme
+   * @param s2 secondo insieme
+   * @return insieme con gli elementi comuni
+   */
+  friend ordered_set operator-(const ordered_set &s1, const ordered_set &s2)
+  {
+    ordered_set s3;
+    s3._dati.reserve(std::min(s1._dati.size(), s2._dati.size()));
+    std::set_intersection(s1._dati.begin(), s1._dati.end(), s2._dati.begin(), s2._dati.end(),
+                          std::back_inserter(s3._dati), s1._less);
+    return s3;
+  }
+
+  /**
+   * @brief filter_out
+   * Funzione GLOBALE che ritorna un insieme con gli elementi di S che
+   * soddisfano il predicato. Gli elementi restano ordinati, quindi
+   * vengono accodati senza ricerche.
+   * @param S insieme su cui applicare il predicato
+   * @param predicato predicato da applicare
+   * @return insieme con gli elementi che verificano il predicato
+   */
+  template <typename P>
+  friend ordered_set filter_out(const ordered_set &S, P predicato)
+  {
+    ordered_set s1;
+    for (const_iterator i = S.begin(); i != S.end(); ++i)
+      if (predicato(*i))
+        s1._dati.push_back(*i);
+    return s1;
+  }
+
+private:
+  /**
+   * @brief Funtore di equivalenza derivato da Less
+   * Usato da std::unique per scartare i duplicati dopo l'ordinamento
+   */
+  struct uguali
+  {
+    Less less; ///< funtore d'ordine
+
+    uguali(const Less &l) : less(l) {}
+
+    bool operator()(const T &a, const T &b) const
+    {
+      return !less(a, b) && !less(b, a);
+    }
+  };
+};
+
+#endif
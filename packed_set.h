@@ -0,0 +1,493 @@
+#ifndef PACKED_SET_H
+#define PACKED_SET_H
+
+#include <ostream>
+#include <cassert>
+#include <algorithm>
+#include <iterator>
+#include <functional>
+#include <type_traits>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PACKED_SET_X86 1
+#include <immintrin.h>
+#endif
+
+/**
+  @brief Uguaglianza bit a bit
+
+  Trait che dichiara che il funtore Eql considera uguali due elementi
+  se e solo se la loro rappresentazione in memoria è identica (nessun
+  byte di padding, nessun campo ignorato). Per questi funtori packed_set
+  confronta gli elementi come interi a 32 o 64 bit con istruzioni
+  vettoriali, quindi gli elementi devono essere anche banalmente
+  copiabili. Va specializzato dall'utente per i propri funtori; è già
+  vero per std::equal_to sui tipi interi.
+*/
+template <typename Eql>
+struct confronto_bit_a_bit : std::false_type
+{
+};
+
+template <typename T>
+struct confronto_bit_a_bit<std::equal_to<T> > : std::is_integral<T>
+{
+};
+
+namespace packed_dettagli
+{
+  /**
+   * @brief Ricerca scalare di una parola da 32 bit
+   * @param p inizio dell'array
+   * @param n numero di elementi
+   * @param v valore da cercare
+   * @return indice del primo elemento uguale a v, n se non presente
+   */
+  inline std::size_t trova_32_scalare(const unsigned char *p, std::size_t n, std::uint32_t v)
+  {
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      std::uint32_t x;
+      std::memcpy(&x, p + 4 * i, 4);
+      if (x == v)
+        return i;
+    }
+    return n;
+  }
+
+  /**
+   * @brief Ricerca scalare di una parola da 64 bit
+   * @param p inizio dell'array
+   * @param n numero di elementi
+   * @param v valore da cercare
+   * @return indice del primo elemento uguale a v, n se non presente
+   */
+  inline std::size_t trova_64_scalare(const unsigned char *p, std::size_t n, std::uint64_t v)
+  {
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      std::uint64_t x;
+      std::memcpy(&x, p + 8 * i, 8);
+      if (x == v)
+        return i;
+    }
+    return n;
+  }
+
+#ifdef PACKED_SET_X86
+  // SSE2: 4 confronti a 32 bit per istruzione
+  __attribute__((target("sse2"))) inline std::size_t trova_32_sse2(const unsigned char *p, std::size_t n, std::uint32_t v)
+  {
+    __m128i chiave = _mm_set1_epi32(static_cast<int>(v));
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+      __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 4 * i));
+      int m = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(x, chiave)));
+      if (m != 0)
+        return i + __builtin_ctz(m);
+    }
+    return i + trova_32_scalare(p + 4 * i, n - i, v);
+  }
+
+  // SSE2 non ha il confronto a 64 bit: un elemento è uguale se lo sono
+  // entrambe le sue metà a 32 bit
+  __attribute__((target("sse2"))) inline std::size_t trova_64_sse2(const unsigned char *p, std::size_t n, std::uint64_t v)
+  {
+    __m128i chiave = _mm_set1_epi64x(static_cast<long long>(v));
+    std::size_t i = 0;
+    for (; i + 2 <= n; i += 2)
+    {
+      __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 8 * i));
+      int m = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(x, chiave)));
+      m &= (m >> 1) & 0x5;
+      if (m != 0)
+        return i + (__builtin_ctz(m) >> 1);
+    }
+    return i + trova_64_scalare(p + 8 * i, n - i, v);
+  }
+
+  // AVX2: 16 confronti a 32 bit per iterazione (due registri da 8)
+  __attribute__((target("avx2"))) inline std::size_t trova_32_avx2(const unsigned char *p, std::size_t n, std::uint32_t v)
+  {
+    __m256i chiave = _mm256_set1_epi32(static_cast<int>(v));
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+      __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + 4 * i));
+      __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + 4 * i + 32));
+      unsigned int ma = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, chiave)));
+      unsigned int mb = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(b, chiave)));
+      unsigned int m = ma | (mb << 8);
+      if (m != 0)
+        return i + __builtin_ctz(m);
+    }
+    for (; i + 8 <= n; i += 8)
+    {
+      __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + 4 * i));
+      int m = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, chiave)));
+      if (m != 0)
+        return i + __builtin_ctz(m);
+    }
+    return i + trova_32_scalare(p + 4 * i, n - i, v);
+  }
+
+  // AVX2: 8 confronti a 64 bit per iterazione (due registri da 4)
+  __attribute__((target("avx2"))) inline std::size_t trova_64_avx2(const unsigned char *p, std::size_t n, std::uint64_t v)
+  {
+    __m256i chiave = _mm256_set1_epi64x(static_cast<long long>(v));
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+      __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + 8 * i));
+      __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + 8 * i + 32));
+      unsigned int ma = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(a, chiave)));
+      unsigned int mb = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(b, chiave)));
+      unsigned int m = ma | (mb << 4);
+      if (m != 0)
+        return i + __builtin_ctz(m);
+    }
+    return i + trova_64_sse2(p + 8 * i, n - i, v);
+  }
+#endif
+
+  typedef std::size_t (*funzione_32)(const unsigned char *, std::size_t, std::uint32_t);
+  typedef std::size_t (*funzione_64)(const unsigned char *, std::size_t, std::uint64_t);
+
+  /**
+   * @brief Sceglie la ricerca a 32 bit migliore per la CPU in uso
+   * @return la funzione di ricerca da usare
+   */
+  inline funzione_32 scegli_32()
+  {
+#ifdef PACKED_SET_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+      return trova_32_avx2;
+    if (__builtin_cpu_supports("sse2"))
+      return trova_32_sse2;
+#endif
+    return trova_32_scalare;
+  }
+
+  /**
+   * @brief Sceglie la ricerca a 64 bit migliore per la CPU in uso
+   * @return la funzione di ricerca da usare
+   */
+  inline funzione_64 scegli_64()
+  {
+#ifdef PACKED_SET_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+      return trova_64_avx2;
+    if (__builtin_cpu_supports("sse2"))
+      return trova_64_sse2;
+#endif
+    return trova_64_scalare;
+  }
+
+  /**
+   * @brief Cerca una parola da 32 bit in un array
+   * La scelta dell'implementazione è fatta alla prima chiamata.
+   * @return indice del primo elemento uguale a v, n se non presente
+   */
+  inline std::size_t trova_32(const unsigned char *p, std::size_t n, std::uint32_t v)
+  {
+    static const funzione_32 f = scegli_32();
+    return f(p, n, v);
+  }
+
+  /**
+   * @brief Cerca una parola da 64 bit in un array
+   * La scelta dell'implementazione è fatta alla prima chiamata.
+   * @return indice del primo elemento uguale a v, n se non presente
+   */
+  inline std::size_t trova_64(const unsigned char *p, std::size_t n, std::uint64_t v)
+  {
+    static const funzione_64 f = scegli_64();
+    return f(p, n, v);
+  }
+}
+
+/**
+  @brief classe packed_set
+
+  Variante di set che memorizza gli elementi in un array contiguo,
+  nell'ordine di inserimento, invece che in una lista di nodi. Pensata
+  per insiemi piccoli o medi di elementi piccoli (interi, punti).
+  Quando Eql è un confronto bit a bit (vedi confronto_bit_a_bit) e T
+  occupa 4 o 8 byte, la ricerca usata da cerca, add e remove confronta
+  8-16 elementi per istruzione con AVX2, o 2-4 con SSE2, scegliendo
+  l'implementazione a runtime; altrimenti scorre l'array con Eql.
+  La ricerca resta lineare: per insiemi grandi conviene set con Hash.
+*/
+template <typename T, typename Eql>
+class packed_set
+{
+  std::vector<T> _dati; ///< elementi in ordine di inserimento
+  Eql _equals;          ///< funtore per l'uguaglianza tra elementi T
+
+  /// modo di ricerca: 4 e 8 parole vettoriali, 0 confronto con Eql
+  static const int modo = !confronto_bit_a_bit<Eql>::value ? 0 : (sizeof(T) == 4 ? 4 : (sizeof(T) == 8 ? 8 : 0));
+  static_assert(modo == 0 || std::is_trivially_copyable<T>::value,
+                "il confronto bit a bit richiede un tipo banalmente copiabile");
+
+  /**
+   * @brief Posizione di un valore nell'array
+   * @param v valore da cercare
+   * @return indice di v, size() se non presente
+   */
+  std::size_t posizione(const T &v) const
+  {
+    return posizione(v, std::integral_constant<int, modo>());
+  }
+
+  std::size_t posizione(const T &v, std::integral_constant<int, 4>) const
+  {
+    std::uint32_t x;
+    std::memcpy(&x, &v, 4);
+    return packed_dettagli::trova_32(reinterpret_cast<const unsigned char *>(_dati.data()), _dati.size(), x);
+  }
+
+  std::size_t posizione(const T &v, std::integral_constant<int, 8>) const
+  {
+    std::uint64_t x;
+    std::memcpy(&x, &v, 8);
+    return packed_dettagli::trova_64(reinterpret_cast<const unsigned char *>(_dati.data()), _dati.size(), x);
+  }
+
+  std::size_t posizione(const T &v, std::integral_constant<int, 0>) const
+  {
+    std::size_t i = 0;
+    while (i < _dati.size() && !_equals(v, _dati[i]))
+      ++i;
+    return i;
+  }
+
+public:
+  /**
+   Gli iteratori scorrono gli elementi in ordine di inserimento e
+   sono solo in lettura.
+   */
+  typedef typename std::vector<T>::const_iterator const_iterator;
+
+  /**
+   * @brief Costruttore di default
+   * @post size() == 0
+   */
+  packed_set() {}
+
+  /**
+   * @brief Costruttore iteratore
+   * Costruttore che crea un packed_set riempito con dati presi da una
+   * sequenza identificata da un iteratore di inizio e uno di fine
+   * @param b iteratore di inizio
+   * @param e iteratore di fine
+   */
+  template <typename Q>
+  packed_set(Q b, Q e)
+  {
+    insert(b, e);
+  }
+
+  /**
+   * @brief Inserimento di una sequenza
+   * Aggiunge gli elementi della sequenza scartando i duplicati. Se un
+   * inserimento fallisce l'insieme torna com'era.
+   * @param b iteratore di inizio
+   * @param e iteratore di fine
+   */
+  template <typename Q>
+  void insert(Q b, Q e)
+  {
+    std::size_t vecchia_size = _dati.size();
+    try
+    {
+      for (; b != e; ++b)
+        add(static_cast<T>(*b));
+    }
+    catch (...)
+    {
+      _dati.resize(vecchia_size);
+      throw;
+    }
+  }
+
+  /**
+   * @brief Svuota l'insieme
+   * @post size() == 0
+   */
+  void svuota()
+  {
+    _dati.clear();
+  }
+
+  /**
+   * @brief Funzione per vedere se l'insieme è vuoto
+   * @return true se l'insieme è vuoto
+   * @return false altrimenti
+   */
+  bool is_empty() const
+  {
+    return _dati.empty();
+  }
+
+  /**
+   * @brief Dimensione
+   * @return il numero di elementi nell'insieme
+   */
+  unsigned int size() const
+  {
+    return static_cast<unsigned int>(_dati.size());
+  }
+
+  /**
+   * @brief Prepara la memoria per n elementi
+   * @param n numero di elementi previsto
+   */
+  void riserva(std::size_t n)
+  {
+    _dati.reserve(n);
+  }
+
+  /**
+   * @brief Aggiunge un elemento in coda se non è già presente
+   * @param v valore da inserire
+   */
+  void add(const T &v)
+  {
+    if (posizione(v) == _dati.size())
+      _dati.push_back(v);
+  }
+
+  /**
+   * @brief Rimuovi
+   * Rimuove l'elemento uguale a v, se presente, mantenendo l'ordine
+   * degli altri elementi
+   * @param v valore da rimuovere
+   */
+  void remove(const T &v)
+  {
+    std::size_t i = posizione(v);
+    if (i != _dati.size())
+      _dati.erase(_dati.begin() + i);
+  }
+
+  /**
+   * @brief Cerca un valore
+   * @param valore valore da cercare
+   * @return true se il valore è presente
+   * @return false altrimenti
+   */
+  bool cerca(const T &valore) const
+  {
+    return posizione(valore) != _dati.size();
+  }
+
+  // Ritorna l'iteratore all'inizio della sequenza dati
+  const_iterator begin() const
+  {
+    return _dati.begin();
+  }
+
+  // Ritorna l'iteratore alla fine della sequenza dati
+  const_iterator end() const
+  {
+    return _dati.end();
+  }
+
+  /**
+   * @brief Operatore[]
+   * Accesso in sola lettura all'i-esimo elemento in ordine di inserimento
+   * @param i posizione dell'elemento
+   * @return elemento in posizione i
+   */
+  const T &operator[](int i) const
+  {
+    assert(i >= 0 && static_cast<unsigned int>(i) < size());
+    return _dati[i];
+  }
+
+  /**
+   * @brief Operatore di uguaglianza
+   * @param other insieme da comparare
+   * @return true se i due insiemi contengono gli stessi elementi
+   * @return false altrimenti
+   */
+  bool operator==(const packed_set &other) const
+  {
+    if (size() != other.size())
+      return false;
+    for (const_iterator i = begin(); i != end(); ++i)
+      if (!other.cerca(*i))
+        return false;
+    return true;
+  }
+
+  /**
+   * @brief Funzione di stream
+   * @param os stream di output
+   * @param s insieme da spedire sullo stream
+   * @return lo stream di output
+   */
+  friend std::ostream &operator<<(std::ostream &os, const packed_set &s)
+  {
+    for (const_iterator i = s.begin(); i != s.end(); ++i)
+      os << *i << " ";
+    return os;
+  }
+
+  /**
+   * @brief filter_out
+   * Funzione GLOBALE che ritorna un insieme con gli elementi di S che
+   * soddisfano il predicato. S non ha duplicati, quindi gli elementi
+   * vengono copiati senza ricerche in un'unica passata sull'array.
+   * @param S insieme su cui applicare il predicato
+   * @param predicato predicato da applicare
+   * @return insieme con gli elementi che verificano il predicato
+   */
+  template <typename P>
+  friend packed_set filter_out(const packed_set &S, P predicato)
+  {
+    packed_set s1;
+    std::copy_if(S._dati.begin(), S._dati.end(), std::back_inserter(s1._dati), predicato);
+    return s1;
+  }
+
+  /**
+   * @brief operatore di unione
+   * @param s1 primo insieme
+   * @param s2 secondo insieme
+   * @return insieme con gli elementi di entrambi, senza duplicati
+   */
+  friend packed_set operator+(const packed_set &s1, const packed_set &s2)
+  {
+    packed_set s3(s1);
+    s3._dati.reserve(s1._dati.size() + s2._dati.size());
+    for (const_iterator i = s2.begin(); i != s2.end(); ++i)
+      if (!s1.cerca(*i))
+        s3._dati.push_back(*i);
+    return s3;
+  }
+
+  /**
+   * @brief operatore di intersezione
+   * @param s1 primo insieme
+   * @param s2 secondo insieme
+   * @return insieme con gli elementi comuni
+   */
+  friend packed_set operator-(const packed_set &s1, const packed_set &s2)
+  {
+    packed_set s3;
+    for (const_iterator i = s1.begin(); i != s1.end(); ++i)
+      if (s2.cerca(*i))
+        s3._dati.push_back(*i);
+    return s3;
+  }
+};
+
+#endif
@@ -0,0 +1,1004 @@
+#ifndef PERSISTENT_SET_H
+#define PERSISTENT_SET_H
+
+#include <ostream>
+#include <iterator>
+#include <vector>
+#include <atomic>
+#include <new>
+#include <cstddef>
+#include <cstdint>
+#include "set.h"
+
+namespace persistent_dettagli
+{
+  /// bit dell'hash consumati a ogni livello del trie
+  const unsigned int bit_livello = 5;
+
+  /// maschera dell'indice di un figlio in un livello
+  const std::size_t maschera_livello = (1u << bit_livello) - 1;
+
+  /// livelli massimi del trie: oltre gli hash sono uguali
+  const unsigned int livelli = (sizeof(std::size_t) * 8 + bit_livello - 1) / bit_livello;
+
+  /// numero di bit a 1 in una mappa dei figli
+  inline unsigned int conta_bit(std::uint32_t x)
+  {
+#if defined(__GNUC__)
+    return static_cast<unsigned int>(__builtin_popcount(x));
+#else
+    unsigned int n = 0;
+    for (; x != 0; x &= x - 1)
+      ++n;
+    return n;
+#endif
+  }
+
+  /// bit della mappa che corrisponde all'hash h al livello con scostamento shift
+  inline std::uint32_t bit_di(std::size_t h, unsigned int shift)
+  {
+    return 1u << ((h >> shift) & maschera_livello);
+  }
+
+  /**
+   * @brief Nodo immutabile del trie, condiviso tra versioni
+   * Il contatore dice quanti padri e quante persistent_set lo usano.
+   */
+  struct nodo
+  {
+    mutable std::atomic<long> riferimenti; ///< proprietari del nodo
+    bool foglia;                           ///< true per le foglie, false per i rami
+
+    explicit nodo(bool f) : riferimenti(1), foglia(f) {}
+  };
+
+  /**
+   * @brief Foglia con un elemento
+   * Elementi diversi con lo stesso hash sono una catena di foglie.
+   */
+  template <typename T>
+  struct foglia : nodo
+  {
+    std::size_t hash;          ///< hash dell'elemento
+    T valore;                  ///< elemento
+    const foglia *collisione;  ///< foglia successiva con lo stesso hash
+
+    foglia(std::size_t h, const T &v, const foglia *c) : nodo(true), hash(h), valore(v), collisione(c) {}
+  };
+
+  /**
+   * @brief Ramo con fino a 32 figli
+   * Sono memorizzati solo i figli presenti, in un array che segue il
+   * ramo nella stessa allocazione, nell'ordine dei bit della mappa.
+   * Un ramo non ha mai come unico figlio una foglia: in quel caso c'è la
+   * foglia al suo posto, quindi la forma del trie dipende solo dagli
+   * elementi.
+   */
+  struct ramo : nodo
+  {
+    std::uint32_t mappa;   ///< bit a 1 per i figli presenti
+    unsigned int elementi; ///< elementi nel sottoalbero
+
+    explicit ramo(std::uint32_t m) : nodo(false), mappa(m), elementi(0) {}
+
+    const nodo **figli()
+    {
+      return reinterpret_cast<const nodo **>(this + 1);
+    }
+
+    const nodo *const *figli() const
+    {
+      return reinterpret_cast<const nodo *const *>(this + 1);
+    }
+
+    unsigned int numero() const
+    {
+      return conta_bit(mappa);
+    }
+
+    /// posizione nell'array del figlio con il bit dato
+    unsigned int posizione(std::uint32_t bit) const
+    {
+      return conta_bit(mappa & (bit - 1));
+    }
+  };
+}
+
+/**
+  @brief classe persistent_set
+
+  Insieme persistente: add e remove non modificano la persistent_set ma
+  ne restituiscono una nuova versione, che condivide con la precedente
+  tutto tranne il cammino dalla radice all'elemento toccato. Gli elementi
+  stanno in un trie sugli hash (HAMT) con 32 figli per livello, quindi
+  add, remove e cerca costano O(log n) in tempo e in nodi nuovi, e tenere
+  molte versioni costa poco più di una sola. Copiare una versione è O(1).
+  I nodi sono immutabili e liberati per conteggio dei riferimenti, quindi
+  le versioni possono essere lette e copiate da thread diversi.
+  Unione, intersezione, filter_out e uguaglianza lavorano sui rami e
+  riusano senza visitarli i sottoalberi condivisi dalle due versioni.
+  Eql deve essere coerente con Hash. L'ordine di iterazione è quello
+  degli hash.
+*/
+template <typename T, typename Eql, typename Hash>
+class persistent_set
+{
+  typedef persistent_dettagli::nodo nodo;
+  typedef persistent_dettagli::ramo ramo;
+  typedef persistent_dettagli::foglia<T> foglia;
+
+  const nodo *_radice; ///< radice del trie, nullptr se vuota
+  unsigned int _size;  ///< numero di elementi
+
+  persistent_set(const nodo *radice, unsigned int size) : _radice(radice), _size(size) {}
+
+  static bool uguali(const T &a, const T &b)
+  {
+    return Eql()(a, b);
+  }
+
+  static std::size_t hash(const T &v)
+  {
+    return set_dettagli::mescola(Hash()(v));
+  }
+
+  /// aggiunge un proprietario a un nodo
+  static const nodo *prendi(const nodo *n)
+  {
+    if (n != nullptr)
+      n->riferimenti.fetch_add(1, std::memory_order_relaxed);
+    return n;
+  }
+
+  /**
+   * @brief Toglie un proprietario a un nodo
+   * L'ultimo proprietario distrugge il nodo e lascia i suoi figli
+   * @param n nodo da lasciare, anche nullptr
+   */
+  static void lascia(const nodo *n)
+  {
+    while (n != nullptr && n->riferimenti.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+      if (n->foglia)
+      {
+        const foglia *f = static_cast<const foglia *>(n);
+        n = f->collisione;
+        delete f;
+      }
+      else
+      {
+        const ramo *r = static_cast<const ramo *>(n);
+        for (unsigned int i = 0; i < r->numero(); ++i)
+          lascia(r->figli()[i]);
+        r->~ramo();
+        ::operator delete(const_cast<ramo *>(r));
+        return;
+      }
+    }
+  }
+
+  /**
+   * @brief Alloca un ramo con i figli non ancora assegnati
+   * @param mappa figli presenti, almeno uno
+   */
+  static ramo *alloca_ramo(std::uint32_t mappa)
+  {
+    void *m = ::operator new(sizeof(ramo) + persistent_dettagli::conta_bit(mappa) * sizeof(const nodo *));
+    return new (m) ramo(mappa);
+  }
+
+  /// numero di elementi sotto un nodo
+  static unsigned int elementi(const nodo *n)
+  {
+    if (n == nullptr)
+      return 0;
+    if (!n->foglia)
+      return static_cast<const ramo *>(n)->elementi;
+    unsigned int k = 0;
+    for (const foglia *f = static_cast<const foglia *>(n); f != nullptr; f = f->collisione)
+      ++k;
+    return k;
+  }
+
+  /**
+   * @brief Costruisce un ramo dai figli dati
+   * I figli nulli vengono saltati; se resta una sola foglia viene
+   * restituita lei al posto del ramo. I figli sono presi in carico anche
+   * in caso di eccezione.
+   * @param figli figli in ordine di bit, di proprietà del chiamante
+   * @param bit bit di ogni figlio
+   * @param k numero di figli
+   * @return il nodo costruito, nullptr se non resta nessun figlio
+   */
+  static const nodo *componi(const nodo **figli, const std::uint32_t *bit, unsigned int k)
+  {
+    unsigned int m = 0;
+    std::uint32_t mappa = 0;
+    for (unsigned int i = 0; i < k; ++i)
+      if (figli[i] != nullptr)
+      {
+        figli[m++] = figli[i];
+        mappa |= bit[i];
+      }
+    if (m == 0)
+      return nullptr;
+    if (m == 1 && figli[0]->foglia)
+      return figli[0];
+    ramo *r;
+    try
+    {
+      r = alloca_ramo(mappa);
+    }
+    catch (...)
+    {
+      for (unsigned int i = 0; i < m; ++i)
+        lascia(figli[i]);
+      throw;
+    }
+    for (unsigned int i = 0; i < m; ++i)
+    {
+      r->figli()[i] = figli[i];
+      r->elementi += elementi(figli[i]);
+    }
+    return r;
+  }
+
+  /**
+   * @brief Copia di un ramo con un figlio sostituito
+   * @param r ramo da copiare
+   * @param pos posizione del figlio da sostituire
+   * @param figlio nuovo figlio, preso in carico
+   */
+  static const nodo *sostituisci(const ramo *r, unsigned int pos, const nodo *figlio)
+  {
+    ramo *c;
+    try
+    {
+      c = alloca_ramo(r->mappa);
+    }
+    catch (...)
+    {
+      lascia(figlio);
+      throw;
+    }
+    for (unsigned int i = 0; i < r->numero(); ++i)
+      c->figli()[i] = i == pos ? figlio : prendi(r->figli()[i]);
+    c->elementi = r->elementi - elementi(r->figli()[pos]) + elementi(figlio);
+    return c;
+  }
+
+  /**
+   * @brief Copia di un ramo con un figlio in più
+   * @param r ramo da copiare
+   * @param bit bit del nuovo figlio, assente in r
+   * @param figlio nuovo figlio, preso in carico
+   */
+  static const nodo *inserisci_figlio(const ramo *r, std::uint32_t bit, const nodo *figlio)
+  {
+    ramo *c;
+    try
+    {
+      c = alloca_ramo(r->mappa | bit);
+    }
+    catch (...)
+    {
+      lascia(figlio);
+      throw;
+    }
+    unsigned int pos = r->posizione(bit);
+    for (unsigned int i = 0, j = 0; j < c->numero(); ++j)
+      c->figli()[j] = j == pos ? figlio : prendi(r->figli()[i++]);
+    c->elementi = r->elementi + elementi(figlio);
+    return c;
+  }
+
+  /**
+   * @brief Ramo che contiene due nodi con hash diversi
+   * Scende finché i due hash non cadono in figli diversi.
+   * @param a primo nodo, preso in carico
+   * @param ha hash degli elementi di a
+   * @param b secondo nodo, preso in carico
+   * @param hb hash degli elementi di b, diverso da ha
+   * @param shift scostamento dell'hash al livello del ramo
+   */
+  static const nodo *coppia(const nodo *a, std::size_t ha, const nodo *b, std::size_t hb, unsigned int shift)
+  {
+    std::uint32_t ba = persistent_dettagli::bit_di(ha, shift);
+    std::uint32_t bb = persistent_dettagli::bit_di(hb, shift);
+    const nodo *figli[2];
+    std::uint32_t bit[2];
+    unsigned int k = 2;
+    if (ba == bb)
+    {
+      figli[0] = coppia(a, ha, b, hb, shift + persistent_dettagli::bit_livello);
+      bit[0] = ba;
+      k = 1;
+    }
+    else if (ba < bb)
+    {
+      figli[0] = a, bit[0] = ba;
+      figli[1] = b, bit[1] = bb;
+    }
+    else
+    {
+      figli[0] = b, bit[0] = bb;
+      figli[1] = a, bit[1] = ba;
+    }
+    return componi(figli, bit, k);
+  }
+
+  /**
+   * @brief Cerca un valore nel sottoalbero di un nodo
+   * @param n nodo da cui partire
+   * @param v valore da cercare
+   * @param h hash di v
+   * @param shift scostamento dell'hash al livello di n
+   */
+  static bool cerca_da(const nodo *n, const T &v, std::size_t h, unsigned int shift)
+  {
+    while (n != nullptr)
+    {
+      if (n->foglia)
+      {
+        for (const foglia *f = static_cast<const foglia *>(n); f != nullptr; f = f->collisione)
+          if (f->hash == h && uguali(f->valore, v))
+            return true;
+        return false;
+      }
+      const ramo *r = static_cast<const ramo *>(n);
+      std::uint32_t bit = persistent_dettagli::bit_di(h, shift);
+      if ((r->mappa & bit) == 0)
+        return false;
+      n = r->figli()[r->posizione(bit)];
+      shift += persistent_dettagli::bit_livello;
+    }
+    return false;
+  }
+
+  /**
+   * @brief Aggiunge un valore al sottoalbero di un nodo
+   * @param n nodo non nullo, non modificato
+   * @param v valore da aggiungere
+   * @param h hash di v
+   * @param shift scostamento dell'hash al livello di n
+   * @return il nuovo nodo, nullptr se v era già presente
+   */
+  static const nodo *aggiungi(const nodo *n, const T &v, std::size_t h, unsigned int shift)
+  {
+    if (n->foglia)
+    {
+      const foglia *f = static_cast<const foglia *>(n);
+      if (f->hash == h)
+      {
+        for (const foglia *c = f; c != nullptr; c = c->collisione)
+          if (uguali(c->valore, v))
+            return nullptr;
+        foglia *nuova = new foglia(h, v, nullptr);
+        nuova->collisione = static_cast<const foglia *>(prendi(f));
+        return nuova;
+      }
+      foglia *nuova = new foglia(h, v, nullptr);
+      return coppia(prendi(f), f->hash, nuova, h, shift);
+    }
+    const ramo *r = static_cast<const ramo *>(n);
+    std::uint32_t bit = persistent_dettagli::bit_di(h, shift);
+    if ((r->mappa & bit) == 0)
+      return inserisci_figlio(r, bit, new foglia(h, v, nullptr));
+    unsigned int pos = r->posizione(bit);
+    const nodo *figlio = aggiungi(r->figli()[pos], v, h, shift + persistent_dettagli::bit_livello);
+    if (figlio == nullptr)
+      return nullptr;
+    return sostituisci(r, pos, figlio);
+  }
+
+  /**
+   * @brief Catena di collisione senza una foglia
+   * Le foglie che precedono quella tolta vengono copiate, il resto è
+   * condiviso.
+   * @param f inizio della catena
+   * @param tolta foglia da togliere
+   */
+  static const nodo *senza(const foglia *f, const foglia *tolta)
+  {
+    std::vector<const foglia *> prima;
+    for (; f != tolta; f = f->collisione)
+      prima.push_back(f);
+    const foglia *testa = static_cast<const foglia *>(prendi(tolta->collisione));
+    try
+    {
+      for (std::size_t i = prima.size(); i-- > 0;)
+        testa = new foglia(prima[i]->hash, prima[i]->valore, testa);
+    }
+    catch (...)
+    {
+      lascia(testa);
+      throw;
+    }
+    return testa;
+  }
+
+  /**
+   * @brief Toglie un valore dal sottoalbero di un nodo
+   * @param n nodo non nullo, non modificato
+   * @param v valore da togliere
+   * @param h hash di v
+   * @param shift scostamento dell'hash al livello di n
+   * @param risultato il nuovo nodo, nullptr se resta vuoto
+   * @return true se v era presente
+   */
+  static bool togli(const nodo *n, const T &v, std::size_t h, unsigned int shift, const nodo *&risultato)
+  {
+    if (n->foglia)
+    {
+      const foglia *f = static_cast<const foglia *>(n);
+      if (f->hash != h)
+        return false;
+      const foglia *c = f;
+      while (c != nullptr && !uguali(c->valore, v))
+        c = c->collisione;
+      if (c == nullptr)
+        return false;
+      risultato = senza(f, c);
+      return true;
+    }
+    const ramo *r = static_cast<const ramo *>(n);
+    std::uint32_t bit = persistent_dettagli::bit_di(h, shift);
+    if ((r->mappa & bit) == 0)
+      return false;
+    unsigned int pos = r->posizione(bit);
+    const nodo *figlio;
+    if (!togli(r->figli()[pos], v, h, shift + persistent_dettagli::bit_livello, figlio))
+      return false;
+    if (figlio != nullptr && (r->numero() > 1 || !figlio->foglia))
+    {
+      risultato = sostituisci(r, pos, figlio);
+      return true;
+    }
+    // il ramo perde un figlio o resta con una sola foglia
+    const nodo *figli[32];
+    std::uint32_t bits[32];
+    unsigned int k = 0;
+    for (std::uint32_t m = r->mappa; m != 0; m &= m - 1, ++k)
+    {
+      bits[k] = m & (~m + 1);
+      figli[k] = k == pos ? figlio : prendi(r->figli()[k]);
+    }
+    risultato = componi(figli, bits, k);
+    return true;
+  }
+
+  /**
+   * @brief Unione di due sottoalberi allo stesso livello
+   * @param a primo nodo, non nullo
+   * @param b secondo nodo, non nullo
+   * @param shift scostamento dell'hash al livello dei nodi
+   * @param comuni incrementato degli elementi presenti in entrambi
+   * @return il nodo unione
+   */
+  static const nodo *unisci(const nodo *a, const nodo *b, unsigned int shift, unsigned int &comuni)
+  {
+    if (a == b)
+    {
+      comuni += elementi(a);
+      return prendi(a);
+    }
+    if (a->foglia && !b->foglia)
+      return unisci(b, a, shift, comuni);
+    if (b->foglia)
+    {
+      const nodo *r = prendi(a);
+      for (const foglia *f = static_cast<const foglia *>(b); f != nullptr; f = f->collisione)
+      {
+        const nodo *nuovo;
+        try
+        {
+          nuovo = aggiungi(r, f->valore, f->hash, shift);
+        }
+        catch (...)
+        {
+          lascia(r);
+          throw;
+        }
+        if (nuovo == nullptr)
+          ++comuni;
+        else
+        {
+          lascia(r);
+          r = nuovo;
+        }
+      }
+      return r;
+    }
+    const ramo *ra = static_cast<const ramo *>(a);
+    const ramo *rb = static_cast<const ramo *>(b);
+    const nodo *figli[32];
+    std::uint32_t bits[32];
+    unsigned int k = 0;
+    try
+    {
+      for (std::uint32_t m = ra->mappa | rb->mappa; m != 0; m &= m - 1, ++k)
+      {
+        std::uint32_t bit = m & (~m + 1);
+        bits[k] = bit;
+        if ((ra->mappa & bit) == 0)
+          figli[k] = prendi(rb->figli()[rb->posizione(bit)]);
+        else if ((rb->mappa & bit) == 0)
+          figli[k] = prendi(ra->figli()[ra->posizione(bit)]);
+        else
+          figli[k] = unisci(ra->figli()[ra->posizione(bit)], rb->figli()[rb->posizione(bit)],
+                            shift + persistent_dettagli::bit_livello, comuni);
+      }
+    }
+    catch (...)
+    {
+      for (unsigned int i = 0; i < k; ++i)
+        lascia(figli[i]);
+      throw;
+    }
+    return componi(figli, bits, k);
+  }
+
+  /**
+   * @brief Catena con le sole foglie che rispettano un predicato
+   * Se le tiene tutte restituisce la catena stessa, condivisa.
+   * @param f inizio della catena
+   * @param p predicato sugli elementi
+   */
+  template <typename P>
+  static const nodo *filtra_catena(const foglia *f, P &p)
+  {
+    std::vector<const foglia *> tenute;
+    unsigned int tutte = 0;
+    for (const foglia *c = f; c != nullptr; c = c->collisione, ++tutte)
+      if (p(c->valore))
+        tenute.push_back(c);
+    if (tenute.size() == tutte)
+      return prendi(f);
+    const foglia *testa = nullptr;
+    try
+    {
+      for (std::size_t i = tenute.size(); i-- > 0;)
+        testa = new foglia(tenute[i]->hash, tenute[i]->valore, testa);
+    }
+    catch (...)
+    {
+      lascia(testa);
+      throw;
+    }
+    return testa;
+  }
+
+  /**
+   * @brief Sottoalbero con i soli elementi che rispettano un predicato
+   * I figli che non cambiano vengono condivisi
+   * @param n nodo non nullo
+   * @param p predicato sugli elementi
+   */
+  template <typename P>
+  static const nodo *filtra(const nodo *n, P &p)
+  {
+    if (n->foglia)
+      return filtra_catena(static_cast<const foglia *>(n), p);
+    const ramo *r = static_cast<const ramo *>(n);
+    const nodo *figli[32];
+    std::uint32_t bits[32];
+    unsigned int k = 0;
+    bool uguale = true;
+    try
+    {
+      for (std::uint32_t m = r->mappa; m != 0; m &= m - 1, ++k)
+      {
+        bits[k] = m & (~m + 1);
+        figli[k] = filtra(r->figli()[k], p);
+        uguale = uguale && figli[k] == r->figli()[k];
+      }
+    }
+    catch (...)
+    {
+      for (unsigned int i = 0; i < k; ++i)
+        lascia(figli[i]);
+      throw;
+    }
+    if (uguale)
+    {
+      for (unsigned int i = 0; i < k; ++i)
+        lascia(figli[i]);
+      return prendi(r);
+    }
+    return componi(figli, bits, k);
+  }
+
+  /**
+   * @brief Predicato: elemento presente in un sottoalbero
+   */
+  struct presente_in
+  {
+    const nodo *n;      ///< sottoalbero in cui cercare
+    unsigned int shift; ///< scostamento dell'hash al livello di n
+
+    bool operator()(const T &v) const
+    {
+      return cerca_da(n, v, hash(v), shift);
+    }
+  };
+
+  /**
+   * @brief Intersezione di due sottoalberi allo stesso livello
+   * @param a primo nodo, non nullo
+   * @param b secondo nodo, non nullo
+   * @param shift scostamento dell'hash al livello dei nodi
+   * @return il nodo intersezione, nullptr se vuota
+   */
+  static const nodo *interseca(const nodo *a, const nodo *b, unsigned int shift)
+  {
+    if (a == b)
+      return prendi(a);
+    if (a->foglia || b->foglia)
+    {
+      if (!a->foglia)
+        std::swap(a, b);
+      presente_in p = {b, shift};
+      return filtra_catena(static_cast<const foglia *>(a), p);
+    }
+    const ramo *ra = static_cast<const ramo *>(a);
+    const ramo *rb = static_cast<const ramo *>(b);
+    const nodo *figli[32];
+    std::uint32_t bits[32];
+    unsigned int k = 0;
+    try
+    {
+      for (std::uint32_t m = ra->mappa & rb->mappa; m != 0; m &= m - 1, ++k)
+      {
+        std::uint32_t bit = m & (~m + 1);
+        bits[k] = bit;
+        figli[k] = interseca(ra->figli()[ra->posizione(bit)], rb->figli()[rb->posizione(bit)],
+                             shift + persistent_dettagli::bit_livello);
+      }
+    }
+    catch (...)
+    {
+      for (unsigned int i = 0; i < k; ++i)
+        lascia(figli[i]);
+      throw;
+    }
+    return componi(figli, bits, k);
+  }
+
+  /**
+   * @brief Confronta due sottoalberi allo stesso livello
+   * La forma del trie dipende solo dagli elementi, quindi due
+   * sottoalberi con mappe diverse contengono elementi diversi. Solo
+   * l'ordine delle catene di collisione può cambiare.
+   */
+  static bool uguale(const nodo *a, const nodo *b)
+  {
+    if (a == b)
+      return true;
+    if (a->foglia != b->foglia)
+      return false;
+    if (a->foglia)
+    {
+      const foglia *fa = static_cast<const foglia *>(a);
+      const foglia *fb = static_cast<const foglia *>(b);
+      if (fa->hash != fb->hash || elementi(fa) != elementi(fb))
+        return false;
+      for (; fa != nullptr; fa = fa->collisione)
+      {
+        const foglia *c = fb;
+        while (c != nullptr && !uguali(c->valore, fa->valore))
+          c = c->collisione;
+        if (c == nullptr)
+          return false;
+      }
+      return true;
+    }
+    const ramo *ra = static_cast<const ramo *>(a);
+    const ramo *rb = static_cast<const ramo *>(b);
+    if (ra->mappa != rb->mappa || ra->elementi != rb->elementi)
+      return false;
+    for (unsigned int i = 0; i < ra->numero(); ++i)
+      if (!uguale(ra->figli()[i], rb->figli()[i]))
+        return false;
+    return true;
+  }
+
+public:
+  /**
+   * @brief Costruttore di default
+   * @post size() == 0
+   */
+  persistent_set() : _radice(nullptr), _size(0) {}
+
+  /**
+   * @brief Copy constructor
+   * Condivide tutti i nodi di other, in O(1)
+   * @param other versione da copiare
+   */
+  persistent_set(const persistent_set &other) noexcept : _radice(prendi(other._radice)), _size(other._size) {}
+
+  /**
+   * @brief Move constructor
+   * @param other versione da cui prendere i nodi, che resta vuota
+   */
+  persistent_set(persistent_set &&other) noexcept : _radice(other._radice), _size(other._size)
+  {
+    other._radice = nullptr;
+    other._size = 0;
+  }
+
+  /**
+   * @brief Costruttore da una sequenza
+   * @param b iteratore di inizio
+   * @param e iteratore di fine
+   */
+  template <typename Q>
+  persistent_set(Q b, Q e) : _radice(nullptr), _size(0)
+  {
+    for (; b != e; ++b)
+      *this = add(static_cast<T>(*b));
+  }
+
+  persistent_set &operator=(const persistent_set &other) noexcept
+  {
+    const nodo *vecchia = _radice;
+    _radice = prendi(other._radice);
+    _size = other._size;
+    lascia(vecchia);
+    return *this;
+  }
+
+  persistent_set &operator=(persistent_set &&other) noexcept
+  {
+    if (this != &other)
+    {
+      lascia(_radice);
+      _radice = other._radice;
+      _size = other._size;
+      other._radice = nullptr;
+      other._size = 0;
+    }
+    return *this;
+  }
+
+  /**
+    Distruttore: lascia i nodi, liberando quelli non usati da altre versioni
+  */
+  ~persistent_set()
+  {
+    lascia(_radice);
+  }
+
+  unsigned int size() const
+  {
+    return _size;
+  }
+
+  bool is_empty() const
+  {
+    return _size == 0;
+  }
+
+  /**
+   * @brief Cerca un elemento
+   * @param valore valore da cercare
+   * @return true se il valore è presente
+   * @return false altrimenti
+   */
+  bool cerca(const T &valore) const
+  {
+    return cerca_da(_radice, valore, hash(valore), 0);
+  }
+
+  /**
+   * @brief Versione con un elemento in più
+   * Copia solo i nodi sul cammino dell'elemento, O(log n)
+   * @param v valore da aggiungere
+   * @return la nuova versione, che condivide i nodi con questa
+   */
+  persistent_set add(const T &v) const
+  {
+    std::size_t h = hash(v);
+    if (_radice == nullptr)
+      return persistent_set(new foglia(h, v, nullptr), 1);
+    const nodo *r = aggiungi(_radice, v, h, 0);
+    if (r == nullptr)
+      return *this;
+    return persistent_set(r, _size + 1);
+  }
+
+  /**
+   * @brief Versione con un elemento in meno
+   * Copia solo i nodi sul cammino dell'elemento, O(log n)
+   * @param v valore da togliere
+   * @return la nuova versione, che condivide i nodi con questa
+   */
+  persistent_set remove(const T &v) const
+  {
+    const nodo *r;
+    if (_radice == nullptr || !togli(_radice, v, hash(v), 0, r))
+      return *this;
+    return persistent_set(r, _size - 1);
+  }
+
+  /**
+   * @brief Operatore di uguaglianza
+   * I sottoalberi condivisi dalle due versioni non vengono visitati
+   * @param other versione da comparare
+   * @return true se contengono gli stessi elementi
+   */
+  bool operator==(const persistent_set &other) const
+  {
+    if (_size != other._size)
+      return false;
+    return _size == 0 || uguale(_radice, other._radice);
+  }
+
+  /**
+   * @brief Iteratore costante sugli elementi, in ordine di hash
+   * Tiene il cammino dalla radice alla foglia corrente.
+   */
+  class const_iterator
+  {
+    const ramo *_rami[persistent_dettagli::livelli]; ///< rami del cammino
+    unsigned int _pos[persistent_dettagli::livelli]; ///< figlio seguito in ogni ramo
+    unsigned int _livello;                           ///< rami nel cammino
+    const foglia *_corrente;                         ///< foglia corrente, nullptr alla fine
+
+    friend class persistent_set;
+
+    explicit const_iterator(const nodo *radice) : _livello(0), _corrente(nullptr)
+    {
+      if (radice != nullptr)
+        scendi(radice);
+    }
+
+    /// segue i primi figli fino a una foglia
+    void scendi(const nodo *n)
+    {
+      while (!n->foglia)
+      {
+        const ramo *r = static_cast<const ramo *>(n);
+        _rami[_livello] = r;
+        _pos[_livello] = 0;
+        ++_livello;
+        n = r->figli()[0];
+      }
+      _corrente = static_cast<const foglia *>(n);
+    }
+
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const T *pointer;
+    typedef const T &reference;
+
+    const_iterator() : _livello(0), _corrente(nullptr) {}
+
+    reference operator*() const
+    {
+      return _corrente->valore;
+    }
+
+    pointer operator->() const
+    {
+      return &_corrente->valore;
+    }
+
+    const_iterator &operator++()
+    {
+      if (_corrente->collisione != nullptr)
+      {
+        _corrente = _corrente->collisione;
+        return *this;
+      }
+      while (_livello > 0)
+      {
+        const ramo *r = _rami[_livello - 1];
+        if (++_pos[_livello - 1] < r->numero())
+        {
+          scendi(r->figli()[_pos[_livello - 1]]);
+          return *this;
+        }
+        --_livello;
+      }
+      _corrente = nullptr;
+      return *this;
+    }
+
+    const_iterator operator++(int)
+    {
+      const_iterator tmp(*this);
+      ++*this;
+      return tmp;
+    }
+
+    bool operator==(const const_iterator &other) const
+    {
+      return _corrente == other._corrente;
+    }
+
+    bool operator!=(const const_iterator &other) const
+    {
+      return _corrente != other._corrente;
+    }
+  };
+
+  const_iterator begin() const
+  {
+    return const_iterator(_radice);
+  }
+
+  const_iterator end() const
+  {
+    return const_iterator();
+  }
+
+  /**
+   * @brief Funzione di stream
+   * Ogni elemento è seguito da uno spazio, come per set
+   * @param os stream di output
+   * @param s versione da spedire sullo stream
+   * @return lo stream di output
+   */
+  friend std::ostream &operator<<(std::ostream &os, const persistent_set &s)
+  {
+    for (const_iterator it = s.begin(); it != s.end(); ++it)
+      os << *it << " ";
+    return os;
+  }
+
+  /**
+   * @brief filter_out
+   * Versione con i soli elementi che rispettano il predicato. I
+   * sottoalberi in cui il predicato tiene tutto sono condivisi con S.
+   * @param S versione su cui applicare il predicato
+   * @param predicato predicato da applicare
+   * @return una versione con gli elementi che verificano il predicato
+   */
+  template <typename P>
+  friend persistent_set filter_out(const persistent_set &S, P predicato)
+  {
+    if (S._radice == nullptr)
+      return S;
+    const nodo *r = filtra(S._radice, predicato);
+    return persistent_set(r, elementi(r));
+  }
+
+  /**
+   * @brief operatore di unione
+   * Fonde i due trie ramo per ramo: i sottoalberi presenti in una sola
+   * versione, o condivisi da entrambe, entrano nel risultato senza copie.
+   * @param s1 prima versione
+   * @param s2 seconda versione
+   * @return una versione con gli elementi di entrambe senza duplicati
+   */
+  friend persistent_set operator+(const persistent_set &s1, const persistent_set &s2)
+  {
+    if (s1._radice == nullptr)
+      return s2;
+    if (s2._radice == nullptr)
+      return s1;
+    unsigned int comuni = 0;
+    const nodo *r = unisci(s1._radice, s2._radice, 0, comuni);
+    return persistent_set(r, s1._size + s2._size - comuni);
+  }
+
+  /**
+   * @brief operatore di intersezione
+   * Visita solo i rami presenti in entrambe le versioni; i sottoalberi
+   * condivisi entrano nel risultato senza copie.
+   * @param s1 prima versione
+   * @param s2 seconda versione
+   * @return una versione con gli elementi comuni tra s1 e s2
+   */
+  friend persistent_set operator-(const persistent_set &s1, const persistent_set &s2)
+  {
+    if (s1._radice == nullptr || s2._radice == nullptr)
+      return persistent_set();
+    const nodo *r = interseca(s1._radice, s2._radice, 0);
+    return persistent_set(r, elementi(r));
+  }
+};
+
+#endif
@@ -1,578 +1,3634 @@
-#ifndef SET_H
-#define SET_H
-
-#include <iostream>
-#include <ostream>
-#include <cassert>
-#include <algorithm>
-#include <iterator>
-#include <cstddef>
-
-
-
-/**
-  @brief classe set
-
-  La classe imlementa una generica lista di elementi T.
-  La lista non può contenere elementi duplicati.
-  La valutazione se due elementi di tipo T sono uguali è realizzato
-  tramite il funtore Eql che prende due elementi a e b, e ritorna
-  verso se i due elementi sono uguali. 
-
-*/
-template <typename T, typename Eql>
-class set
-{
-  /**
-     * @brief Struttura nodo
-     * Struttura nodo interna che viene usata per creare la lista
-     */
-  struct nodo
-  {
-    T valore;   ///<valore da memorizzare
-    nodo *next; ///<puntatore al prossimo nodo della lista
-
-    /**
-        Costruttore di default
-        @post next == nullptr
-        */
-    nodo() : next(nullptr) {}
-
-    /**
-         * @brief Costruttore secondario
-         * Funzione che inizializza un nodo con un valore e un puntatore
-         * passato nella funzione
-         * @param v valore da copiare
-         * @param n puntatore a next
-         * 
-         * @post next == n
-           @post valore == v
-         */
-    nodo(const T &v, nodo *n) : valore(v), next(n) {}
-
-    /**
-         * @brief Copy constructor
-         * Funzione che inizializza un nodo copiandio il valore e il puntatore
-         * di un altro nodo passato nella funzione
-         * @param other nodo da copiare
-         * @post valore == other.valore
-         * @post next == other.next
-         */
-    nodo(const nodo &other) : valore(other.valore), next(other.next) {}
-    /**
-     * @brief operatore di assegnamento
-     * Funzione che copia un nodo in un altro nodo
-     * @param other nodo da copiare
-     * @return reference al nodo this 
-     */
-    nodo &operator=(const nodo &other)
-    {
-      valore = other.valore;
-      next = other.next;
-      return *this;
-    }
-    /**
-      Distruttore. 
-    */
-    ~nodo() {}
-  };
-  nodo *_head;        ///< puntatore al primo nodo della lista (testa)
-  unsigned int _size; ///< numero di elementi nella lista
-  Eql _equals;        ///< funtore per l'uguaglianza tra elementi T
-
-public:
-  /**
-   * @brief Costruttore di default
-   * Funzione che inizializza una set
-   * @post _head == nullptr
-     @post _size == 0
- */
-  set() : _head(nullptr), _size(0) {}
-  /**
- * @brief Copy constructor
- * Funzione che inizializza una set copiando i dati di un altra set
- * passata nella funzione
- * @param other lista da copiare
- * @post _size = other._size
- */
-  set(const set &other) : _head(nullptr), _size(0)
-  {
-    nodo *curr = other._head;
-    try
-    {
-      while (curr != nullptr)
-      {
-        add(curr->valore);
-        curr = curr->next;
-      }
-    }
-    catch (...)
-    {
-      svuota();
-      throw;
-    }
-  }
-
-  /**
-    * @brief 
-    * 
-    * @param other 
-    * @return set& 
-    */
-
-  /**
-   * @brief Operatore di assegnamento
-   * Funzione che copia una set in un altra set
-   * @param other lista da copiare
-   * @return reference alla lista this
-   */
-  set &operator=(const set &other)
-  {
-    if (this != &other)
-    {
-      set tmp(other);
-      std::swap(this->_head, tmp._head);
-      std::swap(this->_size, tmp._size);
-    }
-    return *this;
-  }
-  /**
-    Distruttore 
-    @post _head == nullptr
-    @post _size == 0
-  */
-  ~set()
-  {
-    svuota();
-  }
-  /**
-   * @brief Svuota la lista
-   * @post _head == nullptr
-     @post _size == 0
-   */
-  void svuota()
-  {
-    nodo *curr = _head;
-
-    while (curr != nullptr)
-    {
-      nodo *cnext = curr->next;
-      delete curr;
-      curr = cnext;
-    }
-    _size = 0;
-    _head = nullptr;
-  }
-  /**
-   * @brief Funzione per vedere se una set è vuota
-   * 
-   * @return true se la lista è vuota
-   * @return false altrimenti
-   */
-    bool is_empty(){
-    return this->size==0;
-  }
-  /**
-    * @brief 
-    * Aggiunge un elemento nella lista evitando i duplicati
-    * tramite il funtore di tipo Eql.
-    * @param v valore da inserire nella lista
-    * @post _size = _size+1
-    */
-  void add(const T &v)
-  {
-
-    // Caso di lista vuota
-    if (_size == 0)
-    {
-      nodo *tmp = new nodo(v, nullptr);
-      _head = tmp;
-      _size = 1;
-      return;
-    }
-
-    nodo *curr = _head;
-    nodo *prev = _head;
-
-    while (curr != nullptr)
-    {
-      if (_equals(curr->valore, v))
-      {
-        std::cout << "Valore già presente" << std::endl;
-        return;
-      }
-      prev = curr;
-      curr = curr->next;
-    }
-    nodo *tmp = new nodo(v, nullptr);
-    _size++;
-    prev->next = tmp;
-  }
-
-  /**
-   * @brief Dimensione lista
-   * Ritorna il numero di elementi nella lista
-   * @return il numero di elementi nella lista
-   */
-  unsigned int size() const
-  {
-    return _size;
-  }
-
-  /**
-   * @brief Rimuovi
-   * Funzione che permette di rimuovere un valore passatogli dalla lista
-   * @param v valore da rimuovere
-   */
-  void remove(const T &v)
-  {
-    nodo *curr = _head;
-    nodo *prev = nullptr;
-    if (_equals(v, curr->valore))
-    {
-      _head = curr->next;
-      delete curr;
-      _size--;
-      return;
-    }
-    while (curr != nullptr)
-    {
-      if (_equals(v, curr->valore))
-      {
-        prev->next = curr->next;
-        delete curr;
-        _size--;
-        return;
-      }
-      prev = curr;
-      curr = curr->next;
-    }
-  }
-
-  /**
-   * @brief Costruttore iteratore
-   * Costruttore che crea una set riempita con dati
-     presi da una sequenza identificata da un iteratore di 
-     inizio e uno di fine. Gli iteratori possono essere di
-     qualunque tipo.  
-   * @param b iteratore di inizio
-   * @param e iteratore di fine
-   */
-  template <typename Q>
-  set(Q b, Q e) : _head(nullptr), _size(0)
-  {
-    try
-    {
-      for (; b != e; ++b)
-        add(static_cast<T>(*b)); // la add contiene una new che può fallire
-    }
-    catch (...)
-    {
-      // in caso di errore di memoria si svuota la lista
-      svuota();
-      throw;
-    }
-  }
-
-  /**
-   * @brief Funzione di stream
-   * Funzione GLOBALE che implementa l'operatore di stream.
-     La funzione è templata sulla sett ed è messa
-     friend perchè accediamo ai dati privati di set.
-   * @param os stream di output
-   * @param s set da spedire sullo stream
-   * @return lo stream di output 
-   */
-  friend std::ostream &operator<<(std::ostream &os, const set &s)
-  {
-    nodo *curr = s._head;
-    while (curr != nullptr)
-    {
-      os << curr->valore << " ";
-      curr = curr->next;
-    }
-
-    return os;
-  }
-
-  /**
-   Gli iteratori devono iterare su elementi inseriti nella classe
-   principale. Siccome nella set mettiamo dei elementi di 
-   tipo T, l'iteratore deve iterare sui dati di tipo T.
-   */
-  class const_iterator
-  {
-
-  public:
-    typedef std::forward_iterator_tag iterator_category;
-    typedef T value_type;
-    typedef ptrdiff_t difference_type;
-    typedef const T *pointer;
-    typedef const T &reference;
-
-    const_iterator() : ptr(nullptr)
-    {
-    }
-
-    const_iterator(const const_iterator &other) : ptr(other.ptr)
-    {
-    }
-
-    const_iterator &operator=(const const_iterator &other)
-    {
-      ptr = other.ptr;
-      return *this;
-    }
-
-    ~const_iterator() {}
-
-    // Ritorna il dato riferito dall'iteratore (dereferenziamento)
-    reference operator*() const
-    {
-      return ptr->valore;
-    }
-
-    // Ritorna il puntatore al dato riferito dall'iteratore
-    pointer operator->() const
-    {
-      return &(ptr->valore);
-    }
-
-    // Operatore di iterazione post-incremento
-    const_iterator operator++(int)
-    {
-      const_iterator tmp(*this);
-      ptr = ptr->next;
-      return tmp;
-    }
-
-    // Operatore di iterazione pre-incremento
-    const_iterator &operator++()
-    {
-      ptr = ptr->next;
-      return *this;
-    }
-
-    // Uguaglianza
-    bool operator==(const const_iterator &other) const
-    {
-      return (ptr == other.ptr);
-    }
-
-    // Diversita'
-    bool operator!=(const const_iterator &other) const
-    {
-      return !(other == *this);
-    }
-
-  private:
-    // La classe container deve essere messa friend dell'iteratore per poter
-    // usare il costruttore di inizializzazione.
-    friend class set;
-
-    // Costruttore privato di inizializzazione usato dalla classe container
-    // tipicamente nei metodi begin e end
-    const_iterator(const nodo *p) : ptr(p) {}
-
-    const nodo *ptr;
-
-    // !!! Eventuali altri metodi privati
-
-  }; // classe const_iterator
-
-  // Ritorna l'iteratore all'inizio della sequenza dati
-  const_iterator begin() const
-  {
-    return const_iterator(_head);
-  }
-
-  // Ritorna l'iteratore alla fine della sequenza dati
-  const_iterator end() const
-  {
-    return const_iterator(nullptr);
-  }
-
-  /**
-   * @brief Cerca un valore passato
-   * Cerca se un valore passato è presente nella lista. Usa il
-     funtore Eql.
-   * @param valore valore da cercare nella lista
-   * @return true se il valore è stato trovato
-   * @return false altrimenti
-   */
-  bool cerca(const T &valore) const
-  {
-    nodo *curr = _head;
-
-    while (curr != nullptr)
-    {
-      if (_equals(valore, curr->valore))
-
-        return true;
-      curr = curr->next;
-    }
-    return false;
-  }
-  /**
- * @brief 
- * 
- * @param other 
- * @return true 
- * @return false 
- */
-
-  /**
-   * @brief Operatore di ugualglianza
-   * Controlla se due liste sono uguali tramite il funtore Eql
-   * @param other lista da comparare
-   * @return true se le due liste sono uguali
-   * @return false altrimenti
-   */
-  bool operator==(const set &other) const
-  {
-    bool equal = true;
-    nodo *curr = _head;
-    if (size() == 0 && other.size() == 0)
-    {
-      return true;
-    }
-    if (size() == 0 && other.size() != 0)
-    {
-      return false;
-    }
-    if (size() != 0 && other.size() == 0)
-    {
-      return false;
-    }
-    if (size() != other.size())
-    {
-      return false;
-    }
-    if (size() == other.size())
-    {
-      while (curr != nullptr && equal)
-      {
-        if (!other.cerca(curr->valore))
-        {
-          return false;
-        }
-        else
-          curr = curr->next;
-      }
-      return equal;
-    }
-    return equal;
-  }
-  /**
-   * @brief Operatore[]
-   * Permette di estrarre dalla lista un elemento in una posizione passata nella funzione
-   * @param i posizione dell'elemento che si vuole estrarre
-   * @return  elemento in posizione i
-   */
-  const T &operator[](int i) const
-  {
-    nodo *curr = _head;
-    nodo *prev = _head;
-    int n;
-    assert(i >= 0 && i < size());
-    for (n = 0; n <= i; n += 1)
-    {
-      if (curr != nullptr)
-      {
-        prev = curr;
-        curr = curr->next;
-      }
-    }
-    return prev->valore;
-  }
-};
-
-/**
- * @brief filter_out
- * Funzione che permette di applicare una condizione (predicato)
- * agli elementi della set restituendo solo quelli che la rispettano
- * @tparam T elemento di tipo T
- * @tparam Eql funtore di uguaglianza
- * @tparam P predicato
- * @param S set passata nella funzione su cui applicare il predicato
- * @return una set con gli elementi che verificano il predicato 
- */
-template <typename T, typename Eql, typename P>
-set<T, Eql> filter_out(const set<T, Eql> &S, P predicato)
-{
-  typename set<T, Eql>::const_iterator begin, end;
-  set<T, Eql> s1;
-  begin = S.begin();
-  end = S.end();
-  try{
-  while (begin != end)
-  {
-    if (predicato(*begin))
-    {
-      s1.add(*begin);
-    }
-    begin++;
-  }
-  }catch(...){
-    s1.svuota();
-    throw;
-  }
-  return s1;
-}
-
-/**
- * @brief operatore di unione
- * Funzione che permette di unire due liste senza duplicati
- * @tparam T elemento di tipo T
- * @tparam Eql funtore di uguaglianza
- * @param s1 prima set
- * @param s2 seconda set
- * @return una set in cui all'interno sono presenti tutti gli elementi di entrambe
- * le liste senza duplicati
- */
-template <typename T, typename Eql>
-set<T, Eql> operator+(const set<T, Eql> &s1, const set<T, Eql> &s2)
-{
-  set<T, Eql> s3;
-  s3 = s1;
-  try{
-  for (int i = 0; i < s2.size(); i++)
-  {
-    s3.add(s2[i]);
-  }
-  }catch(...){
-    s3.svuota();
-    throw;
-  }
-  return s3;
-}
-
-/**
- * @brief operatore di intersezione
- * Funzione che permette di ottenere una set con all'interno solo elementi comuni
- * alle due set passate nella funzione
- * @tparam T elemento di tipo T
- * @tparam Eql funtore di uguaglianza
- * @param s1 prima set
- * @param s2 seconda set
- * @return set con elementi comuni tra le due set s1 e s2
- */
-template <typename T, typename Eql>
-set<T, Eql> operator-(const set<T, Eql> &s1, const set<T, Eql> &s2)
-{
-  set<T, Eql> s3;
-  try{
-  for (int i = 0; i < s1.size(); i++)
-  {
-    if (s2.cerca(s1[i]))
-    {
-      s3.add(s1[i]);
-    }
-  }
-  }catch(...){
-    s3.svuota();
-    throw;
-  }
-  return s3;
-}
+#ifndef SET_H
+#define SET_H
+
+#include <iostream>
+#include <ostream>
+#include <cassert>
+#include <algorithm>
+#include <iterator>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+#include <new>
+#include <utility>
+#include <atomic>
+#include <thread>
+#include <exception>
+#include <memory>
+#include <functional>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+/**
+  @brief classe arena
+
+  Area di memoria a crescita monotona da cui più set possono prendere
+  i blocchi per i propri nodi. Le allocazioni sono un semplice
+  spostamento di puntatore e non vengono mai liberate singolarmente:
+  tutta la memoria torna al sistema in una volta con rilascia o con la
+  distruzione dell'arena. Pensata per le set costruite e distrutte
+  nello stesso ambito (ad esempio una richiesta): l'arena deve
+  sopravvivere a tutte le set che la usano.
+*/
+class arena
+{
+  /**
+   * @brief Struttura blocco
+   * Intestazione di un blocco di memoria dell'arena
+   */
+  struct blocco
+  {
+    blocco *next;           ///< blocco allocato in precedenza
+    std::max_align_t allinea; ///< allinea i dati che seguono l'intestazione
+  };
+
+  blocco *_blocchi;        ///< lista dei blocchi allocati
+  char *_libero;           ///< primo byte libero del blocco corrente
+  std::size_t _rimasti;    ///< byte liberi nel blocco corrente
+  std::size_t _dim_blocco; ///< dimensione dei nuovi blocchi
+
+  arena(const arena &other);
+  arena &operator=(const arena &other);
+
+public:
+  /**
+   * @brief Costruttore
+   * @param dim_blocco dimensione in byte dei blocchi chiesti al sistema
+   * @post nessuna memoria allocata
+   */
+  explicit arena(std::size_t dim_blocco = 64 * 1024)
+      : _blocchi(nullptr), _libero(nullptr), _rimasti(0), _dim_blocco(dim_blocco) {}
+
+  /**
+    Distruttore: libera tutti i blocchi
+  */
+  ~arena()
+  {
+    rilascia();
+  }
+
+  /**
+   * @brief Alloca memoria dall'arena
+   * @param byte numero di byte richiesti
+   * @param allineamento allineamento richiesto (potenza di 2)
+   * @return puntatore alla memoria allocata
+   */
+  void *prendi(std::size_t byte, std::size_t allineamento)
+  {
+    std::size_t scarto = (allineamento - reinterpret_cast<std::size_t>(_libero) % allineamento) % allineamento;
+    if (_blocchi == nullptr || scarto + byte > _rimasti)
+    {
+      std::size_t dati = std::max(_dim_blocco, byte + allineamento);
+      blocco *b = static_cast<blocco *>(::operator new(offsetof(blocco, allinea) + dati));
+      b->next = _blocchi;
+      _blocchi = b;
+      _libero = reinterpret_cast<char *>(&b->allinea);
+      _rimasti = dati;
+      scarto = (allineamento - reinterpret_cast<std::size_t>(_libero) % allineamento) % allineamento;
+    }
+    char *p = _libero + scarto;
+    _libero = p + byte;
+    _rimasti -= scarto + byte;
+    return p;
+  }
+
+  /**
+   * @brief Libera tutta la memoria dell'arena
+   * Le set che la usavano non devono più essere usate né distrutte.
+   * @post nessuna memoria allocata
+   */
+  void rilascia()
+  {
+    while (_blocchi != nullptr)
+    {
+      blocco *b = _blocchi->next;
+      ::operator delete(_blocchi);
+      _blocchi = b;
+    }
+    _libero = nullptr;
+    _rimasti = 0;
+  }
+};
+
+namespace set_dettagli
+{
+  /**
+   * @brief Mescola un valore hash
+   * Ridistribuisce i bit di un hash (finalizzatore di MurmurHash3) in modo
+   * che anche funtori banali come std::hash<int>, che ritorna il valore
+   * stesso, producano posizioni ben distribuite nella tabella.
+   * @param h hash da mescolare
+   * @return hash mescolato
+   */
+  inline std::size_t mescola(std::size_t h)
+  {
+    unsigned long long x = h;
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return static_cast<std::size_t>(x);
+  }
+  /**
+   * @brief Chiede alla cpu di portare in cache un indirizzo
+   * Solo un suggerimento: non legge la memoria e non può fallire.
+   * @param p indirizzo da precaricare
+   */
+  inline void precarica(const void *p)
+  {
+#if defined(__GNUC__)
+    __builtin_prefetch(p);
+#else
+    (void)p;
+#endif
+  }
+
+  /// chiavi di anticipo con cui i metodi batch precaricano slot e nodi
+  const std::size_t distanza_precarica = 8;
+
+  /**
+    @brief Buffer di testo davanti a uno stream
+
+    Accumula i caratteri in un blocco grande e li passa allo stream con
+    una sola write per blocco, invece di attraversare lo stream a ogni
+    elemento. I dati ancora nel buffer vengono scritti con svuota o alla
+    distruzione.
+  */
+  class buffer_testo
+  {
+    static const std::size_t dimensione = 1 << 16; ///< byte del blocco
+
+    std::ostream &_os;       ///< stream di destinazione
+    std::vector<char> _dati; ///< blocco di testo
+    std::size_t _usati;      ///< byte già scritti nel blocco
+
+    buffer_testo(const buffer_testo &other);
+    buffer_testo &operator=(const buffer_testo &other);
+
+  public:
+    explicit buffer_testo(std::ostream &os) : _os(os), _dati(dimensione), _usati(0) {}
+
+    ~buffer_testo()
+    {
+      svuota();
+    }
+
+    std::ostream &flusso()
+    {
+      return _os;
+    }
+
+    /// scrive il contenuto del blocco sullo stream
+    void svuota()
+    {
+      if (_usati != 0)
+        _os.write(&_dati[0], static_cast<std::streamsize>(_usati));
+      _usati = 0;
+    }
+
+    /**
+     * @brief Spazio libero contiguo nel blocco
+     * @param n byte richiesti, al più dimensione
+     * @return puntatore ad almeno n byte liberi
+     */
+    char *riserva(std::size_t n)
+    {
+      if (dimensione - _usati < n)
+        svuota();
+      return &_dati[_usati];
+    }
+
+    /// conferma n byte scritti dopo riserva
+    void avanza(std::size_t n)
+    {
+      _usati += n;
+    }
+
+    void scrivi(const char *s, std::size_t n)
+    {
+      if (n > dimensione)
+      {
+        svuota();
+        _os.write(s, static_cast<std::streamsize>(n));
+        return;
+      }
+      std::copy(s, s + n, riserva(n));
+      _usati += n;
+    }
+  };
+
+  /**
+   * @brief Scrive in decimale un intero senza segno
+   * Le cifre vengono prodotte a coppie da una tabella, dalla fine.
+   * @param fine fine dello spazio disponibile
+   * @param x valore
+   * @return inizio delle cifre scritte
+   */
+  inline char *cifre_decimali(char *fine, unsigned long long x)
+  {
+    static const char coppie[] =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+        "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+    while (x >= 100)
+    {
+      unsigned int r = static_cast<unsigned int>(x % 100) * 2;
+      x /= 100;
+      *--fine = coppie[r + 1];
+      *--fine = coppie[r];
+    }
+    if (x >= 10)
+    {
+      unsigned int r = static_cast<unsigned int>(x) * 2;
+      *--fine = coppie[r + 1];
+      *--fine = coppie[r];
+    }
+    else
+      *--fine = static_cast<char>('0' + x);
+    return fine;
+  }
+
+  /**
+   * @brief Scrittura di un valore nel buffer
+   * Caso generale: l'operator<< del tipo, dopo aver svuotato il buffer
+   * per mantenere l'ordine.
+   */
+  template <typename T, typename = void>
+  struct formato_testo
+  {
+    static void scrivi(buffer_testo &b, const T &v)
+    {
+      b.svuota();
+      b.flusso() << v;
+    }
+  };
+
+  /// interi (esclusi bool e i tipi carattere, che lo stream scrive come testo)
+  template <typename T>
+  struct formato_testo<T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value &&
+                                                  !std::is_same<T, char>::value && !std::is_same<T, signed char>::value &&
+                                                  !std::is_same<T, unsigned char>::value && !std::is_same<T, wchar_t>::value &&
+                                                  !std::is_same<T, char16_t>::value && !std::is_same<T, char32_t>::value>::type>
+  {
+    static void scrivi(buffer_testo &b, const T &v)
+    {
+      char *p = b.riserva(24);
+      char tmp[24];
+      unsigned long long x = static_cast<unsigned long long>(v);
+      bool negativo = std::is_signed<T>::value && v < 0;
+      if (negativo)
+        x = 0ULL - x;
+      char *inizio = cifre_decimali(tmp + sizeof(tmp), x);
+      if (negativo)
+        *--inizio = '-';
+      std::size_t n = static_cast<std::size_t>(tmp + sizeof(tmp) - inizio);
+      std::copy(inizio, tmp + sizeof(tmp), p);
+      b.avanza(n);
+    }
+  };
+
+  /// virgola mobile: come lo stream con i flag di default (%g con la sua precisione)
+  template <typename T>
+  struct formato_testo<T, typename std::enable_if<std::is_floating_point<T>::value>::type>
+  {
+    static void scrivi(buffer_testo &b, const T &v)
+    {
+      char *p = b.riserva(64);
+      int precisione = static_cast<int>(b.flusso().precision());
+      int n = std::is_same<T, long double>::value
+                  ? std::snprintf(p, 64, "%.*Lg", precisione, static_cast<long double>(v))
+                  : std::snprintf(p, 64, "%.*g", precisione, static_cast<double>(v));
+      if (n < 0 || n >= 64)
+      {
+        b.svuota();
+        b.flusso() << v;
+        return;
+      }
+      b.avanza(static_cast<std::size_t>(n));
+    }
+  };
+
+  template <>
+  struct formato_testo<std::string>
+  {
+    static void scrivi(buffer_testo &b, const std::string &v)
+    {
+      b.scrivi(v.data(), v.size());
+    }
+  };
+
+  /**
+   * @brief Vero se lo stream ha i flag di formato di default
+   * Solo in questo caso la scrittura nel buffer dà lo stesso testo dello
+   * stream; altrimenti (base, larghezza, showpos, fixed, ...) si usa lo
+   * stream per ogni elemento.
+   */
+  inline bool formato_di_default(const std::ostream &os)
+  {
+    return (os.flags() & ~(std::ios_base::skipws | std::ios_base::unitbuf)) == std::ios_base::dec && os.width() == 0;
+  }
+
+
+  /**
+    @brief Hash memorizzato in un nodo
+
+    Con l'indice hash ogni nodo tiene l'hash mescolato del proprio
+    valore: rimozioni, copie e operazioni tra set non lo ricalcolano, e
+    le ricerche senza indice scartano i nodi con hash diverso senza
+    chiamare Eql. Senza Hash la base è vuota e non occupa spazio, ma
+    queste set non ne hanno alcun vantaggio: ogni confronto resta una
+    chiamata completa a Eql, anche per le stringhe. Un hash non può essere
+    ricavato da solo, perché dovrebbe essere coerente con un Eql
+    qualsiasi (per esempio senza distinguere maiuscole e minuscole). Per
+    scartare i confronti serve passare Hash, oppure usare
+    stringa_internata, il cui Eql confronta solo puntatori.
+  */
+  template <bool presente>
+  struct hash_nodo
+  {
+    std::size_t h; ///< hash mescolato del valore
+
+    std::size_t hash() const { return h; }
+    void memorizza(std::size_t x) { h = x; }
+  };
+
+  template <>
+  struct hash_nodo<false>
+  {
+    std::size_t hash() const { return 0; }
+    void memorizza(std::size_t) {}
+  };
+
+  /**
+   * @brief Base di std::hash per le set
+   * Con attivo == false non è costruibile né invocabile, come lo
+   * std::hash disabilitato di un tipo senza hash.
+   */
+  template <typename S, bool attivo>
+  struct hash_set
+  {
+    std::size_t operator()(const S &s) const
+    {
+      return s.impronta();
+    }
+  };
+
+  template <typename S>
+  struct hash_set<S, false>
+  {
+    hash_set() = delete;
+    hash_set(const hash_set &) = delete;
+    hash_set &operator=(const hash_set &) = delete;
+  };
+
+  /**
+    @brief Impronta di una set
+
+    Somma degli hash mescolati degli elementi, indipendente dall'ordine e
+    aggiornata in O(1) a ogni aggiunta e rimozione. Set uguali hanno la
+    stessa impronta, quindi impronte diverse provano che due set sono
+    diverse. Senza Hash la struttura è vuota.
+  */
+  template <bool presente>
+  struct impronta_set
+  {
+    std::size_t somma; ///< somma degli hash degli elementi
+
+    impronta_set() : somma(0) {}
+    void aggiungi(std::size_t h) { somma += h; }
+    void togli(std::size_t h) { somma -= h; }
+    void azzera() { somma = 0; }
+    std::size_t valore() const { return somma; }
+  };
+
+  template <>
+  struct impronta_set<false>
+  {
+    void aggiungi(std::size_t) {}
+    void togli(std::size_t) {}
+    void azzera() {}
+    std::size_t valore() const { return 0; }
+  };
+
+  /**
+    @brief Indice hash sui nodi di una set
+
+    Tabella ad indirizzamento aperto (linear probing) che associa ad ogni
+    elemento il nodo della lista che lo contiene. Ogni slot memorizza anche
+    l'hash dell'elemento, così i confronti con Eql vengono fatti solo quando
+    gli hash coincidono e il ridimensionamento non ricalcola gli hash.
+    Le cancellazioni usano lo spostamento all'indietro, quindi la tabella
+    non accumula lapidi.
+  */
+  template <typename nodo, typename Hash>
+  class indice_hash
+  {
+    /**
+     * @brief Struttura slot
+     * Elemento della tabella: nodo indicizzato e suo hash
+     */
+    struct slot
+    {
+      nodo *n;       ///< nodo indicizzato (nullptr se lo slot è libero)
+      std::size_t h; ///< hash mescolato del valore del nodo
+    };
+
+    slot *_slot;            ///< tabella degli slot
+    std::size_t _capacita;  ///< numero di slot (potenza di 2)
+    std::size_t _usati;     ///< numero di slot occupati
+    Hash _hash;             ///< funtore di hash sugli elementi
+
+    indice_hash(const indice_hash &other);
+    indice_hash &operator=(const indice_hash &other);
+
+  public:
+    static const bool attivo = true; ///< l'indice viene mantenuto
+
+    /**
+     * @brief Costruttore di default
+     * @post _capacita == 0
+     * @post _usati == 0
+     */
+    indice_hash() : _slot(nullptr), _capacita(0), _usati(0) {}
+
+    /**
+      Distruttore
+    */
+    ~indice_hash()
+    {
+      delete[] _slot;
+    }
+
+    /**
+     * @brief Calcola l'hash di un valore
+     * @param v valore di cui calcolare l'hash
+     * @return hash mescolato di v
+     */
+    template <typename T>
+    std::size_t calcola(const T &v) const
+    {
+      return mescola(_hash(v));
+    }
+
+    /**
+     * @brief Cerca il nodo che contiene un valore
+     * @param v valore da cercare
+     * @param h hash di v calcolato con calcola
+     * @param equals funtore di uguaglianza della set
+     * @return il nodo che contiene v, nullptr se non presente
+     */
+    template <typename T, typename Eql>
+    nodo *trova(const T &v, std::size_t h, const Eql &equals) const
+    {
+      if (_capacita == 0)
+        return nullptr;
+      std::size_t maschera = _capacita - 1;
+      for (std::size_t i = h & maschera;; i = (i + 1) & maschera)
+      {
+        if (_slot[i].n == nullptr)
+          return nullptr;
+        if (_slot[i].h == h && equals(_slot[i].n->valore, v))
+          return _slot[i].n;
+      }
+    }
+
+    /**
+     * @brief Precarica lo slot da cui parte la ricerca di un hash
+     * @param h hash mescolato
+     */
+    void precarica(std::size_t h) const
+    {
+      if (_capacita != 0)
+        set_dettagli::precarica(&_slot[h & (_capacita - 1)]);
+    }
+
+    /**
+     * @brief Precarica il primo nodo indicizzato con un dato hash
+     * Legge gli slot, quindi conviene chiamarla quando precarica ha già
+     * portato in cache quello iniziale.
+     * @param h hash mescolato
+     */
+    void precarica_nodo(std::size_t h) const
+    {
+      if (_capacita == 0)
+        return;
+      std::size_t maschera = _capacita - 1;
+      for (std::size_t i = h & maschera; _slot[i].n != nullptr; i = (i + 1) & maschera)
+        if (_slot[i].h == h)
+        {
+          set_dettagli::precarica(_slot[i].n);
+          return;
+        }
+    }
+
+    /**
+     * @brief Indicizza un nodo
+     * Il valore del nodo non deve essere già presente nell'indice.
+     * Se la tabella viene ingrandita e l'allocazione fallisce l'indice
+     * resta invariato.
+     * @param n nodo da indicizzare
+     * @param h hash del valore del nodo
+     */
+    void inserisci(nodo *n, std::size_t h)
+    {
+      if ((_usati + 1) * 4 > _capacita * 3)
+        ridimensiona(_capacita == 0 ? 16 : _capacita * 2);
+      posiziona(n, h);
+      _usati++;
+    }
+
+    /**
+     * @brief Toglie un nodo dall'indice
+     * @param n nodo da togliere, deve essere indicizzato
+     * @param h hash del valore del nodo
+     */
+    void rimuovi(nodo *n, std::size_t h)
+    {
+      std::size_t maschera = _capacita - 1;
+      std::size_t i = h & maschera;
+      while (_slot[i].n != n)
+        i = (i + 1) & maschera;
+
+      // Spostamento all'indietro: gli elementi successivi della stessa
+      // sequenza di probing che possono occupare il buco vi vengono spostati
+      std::size_t j = i;
+      for (;;)
+      {
+        j = (j + 1) & maschera;
+        if (_slot[j].n == nullptr)
+          break;
+        std::size_t k = _slot[j].h & maschera;
+        bool resta = (i <= j) ? (i < k && k <= j) : (i < k || k <= j);
+        if (!resta)
+        {
+          _slot[i] = _slot[j];
+          i = j;
+        }
+      }
+      _slot[i].n = nullptr;
+      _usati--;
+    }
+
+    /**
+     * @brief Prepara l'indice a contenere n elementi senza ridimensionarsi
+     * @param n numero di elementi previsto
+     */
+    void riserva(std::size_t n)
+    {
+      std::size_t c = 16;
+      while (c * 3 < n * 4)
+        c *= 2;
+      if (c > _capacita)
+        ridimensiona(c);
+    }
+
+    /**
+     * @brief Memoria occupata dall'indice
+     * @return byte della tabella
+     */
+    std::size_t byte() const
+    {
+      return _capacita * sizeof(slot);
+    }
+
+    /**
+     * @brief Svuota l'indice liberando la tabella
+     * @post _capacita == 0
+     * @post _usati == 0
+     */
+    void svuota()
+    {
+      delete[] _slot;
+      _slot = nullptr;
+      _capacita = 0;
+      _usati = 0;
+    }
+
+    /**
+     * @brief Scambia il contenuto di due indici
+     * @param other indice con cui scambiare
+     */
+    void scambia(indice_hash &other)
+    {
+      std::swap(_slot, other._slot);
+      std::swap(_capacita, other._capacita);
+      std::swap(_usati, other._usati);
+      std::swap(_hash, other._hash);
+    }
+
+  private:
+    // Mette il nodo nel primo slot libero della sua sequenza di probing
+    void posiziona(nodo *n, std::size_t h)
+    {
+      std::size_t maschera = _capacita - 1;
+      std::size_t i = h & maschera;
+      while (_slot[i].n != nullptr)
+        i = (i + 1) & maschera;
+      _slot[i].n = n;
+      _slot[i].h = h;
+    }
+
+    // Rialloca la tabella con c slot e reinserisce i nodi con gli hash salvati
+    void ridimensiona(std::size_t c)
+    {
+      slot *nuovi = new slot[c]();
+      slot *vecchi = _slot;
+      std::size_t vecchia_capacita = _capacita;
+      _slot = nuovi;
+      _capacita = c;
+      for (std::size_t i = 0; i < vecchia_capacita; ++i)
+        if (vecchi[i].n != nullptr)
+          posiziona(vecchi[i].n, vecchi[i].h);
+      delete[] vecchi;
+    }
+  };
+
+  /**
+    @brief Indice assente
+
+    Specializzazione usata quando la set non ha un funtore di hash:
+    tutte le operazioni sono vuote e la ricerca scorre la lista.
+  */
+  template <typename nodo>
+  class indice_hash<nodo, void>
+  {
+  public:
+    static const bool attivo = false; ///< l'indice non viene mantenuto
+
+    template <typename T>
+    std::size_t calcola(const T &) const { return 0; }
+    void precarica(std::size_t) const {}
+    void precarica_nodo(std::size_t) const {}
+    void inserisci(nodo *, std::size_t) {}
+    void rimuovi(nodo *, std::size_t) {}
+    void riserva(std::size_t) {}
+    std::size_t byte() const { return 0; }
+    void svuota() {}
+    void scambia(indice_hash &) {}
+  };
+
+  /**
+    @brief Pool di nodi di una set
+
+    Fornisce la memoria per i nodi prendendola a blocchi (slab) di
+    dimensione crescente, dal sistema o da un'arena condivisa. I nodi
+    liberati finiscono in una lista libera e vengono riusati. rilascia
+    restituisce tutti i blocchi in una volta, senza passare dai singoli
+    nodi. Il pool fornisce solo memoria grezza: costruzione e distruzione
+    dei nodi sono a carico della set.
+  */
+  template <typename nodo>
+  class pool_nodi
+  {
+    /**
+     * @brief Struttura cella
+     * Memoria di un nodo: contiene il nodo quando è in uso, il puntatore
+     * alla cella libera successiva quando è nella lista libera
+     */
+    union cella
+    {
+      cella *libera; ///< prossima cella libera
+      typename std::aligned_storage<sizeof(nodo), alignof(nodo)>::type dati; ///< memoria del nodo
+    };
+
+    /**
+     * @brief Struttura blocco
+     * Intestazione di un blocco di celle allocato dal sistema
+     */
+    struct blocco
+    {
+      blocco *next; ///< blocco allocato in precedenza
+      cella celle[1]; ///< prima cella del blocco
+    };
+
+    static const std::size_t primo_blocco = 8;    ///< celle del primo blocco
+    static const std::size_t massimo_blocco = 1024; ///< celle massime per blocco
+
+    arena *_arena;          ///< arena da cui prendere i blocchi (nullptr: sistema)
+    blocco *_blocchi;       ///< blocchi allocati dal sistema
+    cella *_libere;         ///< lista delle celle libere
+    cella *_prossima;       ///< prima cella mai usata del blocco corrente
+    std::size_t _rimaste;   ///< celle mai usate nel blocco corrente
+    std::size_t _dim_prossimo; ///< celle del prossimo blocco
+    std::size_t _byte;      ///< byte dei blocchi presi finora
+
+    pool_nodi(const pool_nodi &other);
+    pool_nodi &operator=(const pool_nodi &other);
+
+  public:
+    /**
+     * @brief Costruttore
+     * @param a arena da cui prendere i blocchi, nullptr per usare il sistema
+     */
+    explicit pool_nodi(arena *a = nullptr)
+        : _arena(a), _blocchi(nullptr), _libere(nullptr), _prossima(nullptr),
+          _rimaste(0), _dim_prossimo(primo_blocco), _byte(0) {}
+
+    /**
+      Distruttore: restituisce i blocchi al sistema
+    */
+    ~pool_nodi()
+    {
+      rilascia();
+    }
+
+    /**
+     * @brief Arena usata dal pool
+     * @return l'arena, nullptr se i blocchi vengono dal sistema
+     */
+    arena *sorgente() const
+    {
+      return _arena;
+    }
+
+    /**
+     * @brief Memoria occupata dal pool
+     * @return byte dei blocchi presi, in uso o no
+     */
+    std::size_t byte() const
+    {
+      return _byte;
+    }
+
+    /**
+     * @brief Memoria per un nodo
+     * @return puntatore a memoria non inizializzata adatta a un nodo
+     */
+    void *prendi()
+    {
+      if (_libere != nullptr)
+      {
+        cella *c = _libere;
+        _libere = c->libera;
+        return c;
+      }
+      if (_rimaste == 0)
+        nuovo_blocco();
+      _rimaste--;
+      return _prossima++;
+    }
+
+    /**
+     * @brief Prepara la memoria per n nodi
+     * Se le celle rimaste nel blocco corrente non bastano, le mette
+     * nella lista libera e prende un blocco di n celle.
+     * @param n numero di nodi previsto
+     */
+    void riserva(std::size_t n)
+    {
+      if (n <= _rimaste)
+        return;
+      while (_rimaste > 0)
+      {
+        libera(_prossima++);
+        _rimaste--;
+      }
+      std::size_t dim = _dim_prossimo;
+      _dim_prossimo = n;
+      nuovo_blocco();
+      _dim_prossimo = dim;
+    }
+
+    /**
+     * @brief Restituisce la memoria di un nodo già distrutto
+     * @param p memoria ottenuta da prendi
+     */
+    void libera(void *p)
+    {
+      cella *c = static_cast<cella *>(p);
+      c->libera = _libere;
+      _libere = c;
+    }
+
+    /**
+     * @brief Restituisce tutti i blocchi
+     * I nodi devono essere già stati distrutti. Il costo dipende dal
+     * numero di blocchi, non dal numero di nodi; con un'arena i blocchi
+     * restano all'arena fino al suo rilascio.
+     */
+    void rilascia()
+    {
+      while (_blocchi != nullptr)
+      {
+        blocco *b = _blocchi->next;
+        ::operator delete(_blocchi);
+        _blocchi = b;
+      }
+      _libere = nullptr;
+      _prossima = nullptr;
+      _rimaste = 0;
+      _dim_prossimo = primo_blocco;
+      _byte = 0;
+    }
+
+    /**
+     * @brief Scambia il contenuto di due pool
+     * @param other pool con cui scambiare
+     */
+    void scambia(pool_nodi &other)
+    {
+      std::swap(_arena, other._arena);
+      std::swap(_blocchi, other._blocchi);
+      std::swap(_libere, other._libere);
+      std::swap(_prossima, other._prossima);
+      std::swap(_rimaste, other._rimaste);
+      std::swap(_dim_prossimo, other._dim_prossimo);
+      std::swap(_byte, other._byte);
+    }
+
+  private:
+    // Prende un nuovo blocco di celle e raddoppia la dimensione del successivo
+    void nuovo_blocco()
+    {
+      std::size_t n = _dim_prossimo;
+      if (_arena != nullptr)
+      {
+        _prossima = static_cast<cella *>(_arena->prendi(n * sizeof(cella), alignof(cella)));
+      }
+      else
+      {
+        blocco *b = static_cast<blocco *>(::operator new(offsetof(blocco, celle) + n * sizeof(cella)));
+        b->next = _blocchi;
+        _blocchi = b;
+        _prossima = b->celle;
+      }
+      _rimaste = n;
+      _byte += n * sizeof(cella);
+      if (_dim_prossimo < massimo_blocco)
+        _dim_prossimo *= 2;
+    }
+  };
+
+  /**
+    @brief Buffer interno di nodi di una set
+
+    Celle per N nodi contenute nell'oggetto set stesso. Finché il buffer
+    è attivo i nodi vengono presi da qui, senza allocazioni; quando non
+    basta più la set sposta i nodi nel pool e lo disattiva, e lo riattiva
+    solo quando torna vuota. Quindi i nodi di una set stanno tutti nel
+    buffer o tutti fuori. Con N == 0 non c'è buffer.
+  */
+  template <typename nodo, std::size_t N>
+  class buffer_nodi
+  {
+    union cella
+    {
+      cella *libera; ///< prossima cella libera
+      typename std::aligned_storage<sizeof(nodo), alignof(nodo)>::type dati; ///< memoria del nodo
+    };
+
+    cella _celle[N];    ///< celle del buffer
+    cella *_libere;     ///< lista delle celle liberate
+    std::size_t _usate; ///< celle già prese almeno una volta
+    bool _attivo;       ///< i nuovi nodi vanno nel buffer
+
+    buffer_nodi(const buffer_nodi &other);
+    buffer_nodi &operator=(const buffer_nodi &other);
+
+  public:
+    buffer_nodi() : _libere(nullptr), _usate(0), _attivo(true) {}
+
+    bool attivo() const
+    {
+      return _attivo;
+    }
+
+    /// true se non ci sono celle libere
+    bool pieno() const
+    {
+      return _libere == nullptr && _usate == N;
+    }
+
+    /**
+     * @brief Memoria per un nodo
+     * @pre attivo() e !pieno()
+     */
+    void *prendi()
+    {
+      if (_libere != nullptr)
+      {
+        cella *c = _libere;
+        _libere = c->libera;
+        return c;
+      }
+      return &_celle[_usate++];
+    }
+
+    void libera(void *p)
+    {
+      cella *c = static_cast<cella *>(p);
+      c->libera = _libere;
+      _libere = c;
+    }
+
+    /// true se p è una cella del buffer
+    bool interna(const void *p) const
+    {
+      std::less<const void *> minore;
+      return !minore(p, _celle) && minore(p, _celle + N);
+    }
+
+    /// libera tutte le celle e riattiva il buffer; i nodi devono essere già distrutti
+    void azzera()
+    {
+      _libere = nullptr;
+      _usate = 0;
+      _attivo = true;
+    }
+
+    /// libera tutte le celle e manda i nuovi nodi al pool
+    void disattiva()
+    {
+      azzera();
+      _attivo = false;
+    }
+
+    /// scambia lo stato di due buffer senza nodi
+    void scambia(buffer_nodi &other)
+    {
+      std::swap(_attivo, other._attivo);
+    }
+  };
+
+  template <typename nodo>
+  class buffer_nodi<nodo, 0>
+  {
+  public:
+    bool attivo() const { return false; }
+    bool pieno() const { return true; }
+    void *prendi() { return nullptr; }
+    void libera(void *) {}
+    bool interna(const void *) const { return false; }
+    void azzera() {}
+    void disattiva() {}
+    void scambia(buffer_nodi &) {}
+  };
+
+  /**
+    @brief Filtro di Bloom a conteggio
+
+    Risponde "forse presente" o "sicuramente assente" a partire da un
+    hash mescolato, e a differenza di un filtro di Bloom classico
+    permette di togliere gli elementi. Ogni hash sceglie un blocco di
+    64 byte (128 contatori da 4 bit) e k contatori al suo interno, quindi
+    ogni operazione tocca una sola linea di cache. Un contatore arrivato
+    a 15 non viene più decrementato: il filtro può solo perdere
+    precisione, mai dare falsi negativi.
+  */
+  class filtro_conteggio
+  {
+    static const std::size_t contatori_per_blocco = 128;
+    static const std::size_t parole_per_blocco = 8;
+
+    std::vector<std::uint64_t> _parole; ///< contatori, 16 per parola
+    std::size_t _maschera;              ///< blocchi - 1 (blocchi potenza di 2)
+    unsigned int _k;                    ///< contatori per elemento
+    std::size_t _capacita;              ///< elementi per cui è dimensionato
+    double _fp;                         ///< tasso di falsi positivi voluto
+
+    /**
+     * @brief Calcola blocco e contatori di un hash e applica f a ognuno
+     * Il blocco viene dai bit alti dell'hash, ogni contatore da 7 bit di
+     * un secondo hash rimescolato quando i bit finiscono.
+     * @param h hash mescolato
+     * @param f funzione chiamata con (parola, spostamento del contatore)
+     * @return false appena f ritorna false, true altrimenti
+     */
+    template <typename F>
+    bool per_contatori(std::size_t h, F f) const
+    {
+      std::uint64_t x = static_cast<std::uint64_t>(h) * 0x9E3779B97F4A7C15ULL;
+      std::size_t base = static_cast<std::size_t>((x >> 32) & _maschera) * parole_per_blocco;
+      std::uint64_t bit = x;
+      for (unsigned int i = 0; i < _k; ++i, bit >>= 7)
+      {
+        if (i % 9 == 0)
+          bit = x = (x ^ (x >> 31)) * 0xBF58476D1CE4E5B9ULL;
+        unsigned int a = static_cast<unsigned int>(bit & 127);
+        if (!f(base + a / 16, (a % 16) * 4))
+          return false;
+      }
+      return true;
+    }
+
+  public:
+    /**
+     * @brief Costruttore
+     * @param capacita numero di elementi previsto
+     * @param fp tasso di falsi positivi voluto con capacita elementi (0 < fp < 1)
+     */
+    filtro_conteggio(std::size_t capacita, double fp) : _capacita(std::max<std::size_t>(capacita, 1)), _fp(fp)
+    {
+      assert(fp > 0 && fp < 1);
+      const double ln2 = std::log(2.0);
+      double m = -static_cast<double>(_capacita) * std::log(fp) / (ln2 * ln2);
+      std::size_t blocchi = 1;
+      while (blocchi * contatori_per_blocco < m)
+        blocchi *= 2;
+      _k = static_cast<unsigned int>(std::max(1.0, std::min(16.0, std::floor(-std::log(fp) / ln2 + 0.5))));
+      // i blocchi si riempiono in modo non uniforme: si raddoppiano
+      // finché la stima con capacita elementi non rientra nel tasso
+      for (_maschera = blocchi - 1; stima(_capacita) > fp; _maschera = 2 * _maschera + 1)
+        ;
+      _parole.assign((_maschera + 1) * parole_per_blocco, 0);
+    }
+
+    std::size_t capacita() const { return _capacita; }
+    double obiettivo() const { return _fp; }
+
+    /**
+     * @brief Memoria occupata dai contatori
+     * @return byte dei contatori
+     */
+    std::size_t byte() const
+    {
+      return _parole.size() * sizeof(std::uint64_t);
+    }
+
+    /**
+     * @brief Registra un elemento
+     * @param h hash mescolato dell'elemento
+     */
+    void aggiungi(std::size_t h)
+    {
+      per_contatori(h, [this](std::size_t p, unsigned int s) {
+        if (((_parole[p] >> s) & 15) != 15)
+          _parole[p] += std::uint64_t(1) << s;
+        return true;
+      });
+    }
+
+    /**
+     * @brief Toglie un elemento registrato con aggiungi
+     * @param h hash mescolato dell'elemento
+     */
+    void togli(std::size_t h)
+    {
+      per_contatori(h, [this](std::size_t p, unsigned int s) {
+        std::uint64_t c = (_parole[p] >> s) & 15;
+        if (c != 15 && c != 0)
+          _parole[p] -= std::uint64_t(1) << s;
+        return true;
+      });
+    }
+
+    /**
+     * @brief Verifica se un elemento può essere presente
+     * @param h hash mescolato dell'elemento
+     * @return false se l'elemento è sicuramente assente
+     */
+    bool forse(std::size_t h) const
+    {
+      return per_contatori(h, [this](std::size_t p, unsigned int s) {
+        return ((_parole[p] >> s) & 15) != 0;
+      });
+    }
+
+    /**
+     * @brief Azzera i contatori mantenendo il dimensionamento
+     */
+    void svuota()
+    {
+      std::fill(_parole.begin(), _parole.end(), 0);
+    }
+
+    /**
+     * @brief Tasso di falsi positivi stimato
+     * Media sul numero j di elementi nel blocco (poissoniano) della
+     * probabilità che i k contatori siano tutti occupati.
+     * @param n elementi presenti
+     * @return la stima
+     */
+    double stima(std::size_t n) const
+    {
+      double lambda = static_cast<double>(n) / (_maschera + 1);
+      double p = std::exp(-lambda); // probabilità di j elementi, j = 0
+      double fp = 0;
+      double massimo = lambda + 10 * std::sqrt(lambda) + 20;
+      for (double j = 0; j <= massimo; ++j)
+      {
+        double occupato = 1 - std::pow(1 - 1.0 / contatori_per_blocco, _k * j);
+        fp += p * std::pow(occupato, static_cast<double>(_k));
+        p *= lambda / (j + 1);
+      }
+      return fp;
+    }
+  };
+
+  /// elementi per thread sotto cui non conviene dividere il lavoro
+  const std::size_t minimo_per_thread = 2048;
+
+  /**
+   * @brief Valuta un test su una sequenza dividendola tra più thread
+   * La sequenza viene divisa in blocchi contigui, uno per thread; ogni
+   * thread usa una propria copia del test e scrive l'esito dei propri
+   * elementi in esito. Il thread chiamante elabora l'ultimo blocco.
+   * Se un thread lancia un'eccezione, la prima viene rilanciata dopo
+   * che tutti i thread sono terminati.
+   * @param b iteratore di inizio della sequenza
+   * @param n numero di elementi della sequenza
+   * @param thread numero massimo di thread
+   * @param test funtore da valutare su ogni elemento
+   * @param esito esito del test per ogni elemento, nell'ordine della sequenza
+   */
+  template <typename It, typename F>
+  void marca_in_parallelo(It b, std::size_t n, unsigned int thread, const F &test, std::vector<char> &esito)
+  {
+    esito.assign(n, 0);
+    std::size_t k = std::min<std::size_t>(thread, n / minimo_per_thread);
+    if (k <= 1)
+    {
+      F t(test);
+      for (std::size_t i = 0; i < n; ++i, ++b)
+        esito[i] = t(*b) ? 1 : 0;
+      return;
+    }
+
+    std::vector<It> inizi;
+    std::vector<std::size_t> confini;
+    for (std::size_t j = 0, i = 0; j < k; ++j)
+    {
+      std::size_t fine = n * (j + 1) / k;
+      inizi.push_back(b);
+      confini.push_back(i);
+      for (; i < fine; ++i)
+        ++b;
+    }
+    confini.push_back(n);
+
+    std::vector<std::exception_ptr> errori(k);
+    auto lavora = [&](std::size_t j) {
+      try
+      {
+        F t(test);
+        It curr = inizi[j];
+        for (std::size_t i = confini[j]; i < confini[j + 1]; ++i, ++curr)
+          esito[i] = t(*curr) ? 1 : 0;
+      }
+      catch (...)
+      {
+        errori[j] = std::current_exception();
+      }
+    };
+
+    std::vector<std::thread> lavoratori;
+    try
+    {
+      for (std::size_t j = 0; j + 1 < k; ++j)
+        lavoratori.push_back(std::thread(lavora, j));
+    }
+    catch (...)
+    {
+      for (std::size_t j = 0; j < lavoratori.size(); ++j)
+        lavoratori[j].join();
+      throw;
+    }
+    lavora(k - 1);
+    for (std::size_t j = 0; j < lavoratori.size(); ++j)
+      lavoratori[j].join();
+    for (std::size_t j = 0; j < k; ++j)
+      if (errori[j])
+        std::rethrow_exception(errori[j]);
+  }
+}
+
+
+
+/**
+  @brief Istantanea delle statistiche di una set
+
+  Valori dei contatori di una set in un dato momento, ottenuti con
+  set::stats(). I contatori sono quelli dell'istanza: una copia parte
+  da zero. Con la politica senza_statistiche i contatori valgono zero,
+  mentre byte_in_uso è sempre calcolato.
+*/
+struct statistiche_set
+{
+  unsigned long aggiunte;    ///< elementi inseriti
+  unsigned long duplicati;   ///< inserimenti scartati perché già presenti
+  unsigned long rimozioni;   ///< elementi rimossi
+  unsigned long ricerche;    ///< ricerche di un elemento (cerca, add, remove)
+  unsigned long confronti;   ///< chiamate al funtore Eql
+  unsigned long allocazioni; ///< nodi allocati
+  unsigned long liberazioni; ///< nodi liberati
+  unsigned long prefiltrate;    ///< ricerche respinte dal prefiltro
+  unsigned long falsi_positivi; ///< ricerche passate dal prefiltro senza trovare
+  std::size_t byte_in_uso;   ///< memoria di nodi, indici e prefiltro
+
+  /**
+   * @brief Costruttore di default
+   * @post tutti i contatori a zero
+   */
+  statistiche_set()
+      : aggiunte(0), duplicati(0), rimozioni(0), ricerche(0), confronti(0),
+        allocazioni(0), liberazioni(0), prefiltrate(0), falsi_positivi(0), byte_in_uso(0) {}
+
+  /**
+   * @brief Confronti medi per ricerca
+   * @return confronti / ricerche, 0 se non ci sono state ricerche
+   */
+  double confronti_per_ricerca() const
+  {
+    return ricerche == 0 ? 0.0 : static_cast<double>(confronti) / ricerche;
+  }
+
+  /**
+   * @brief Tasso di falsi positivi osservato del prefiltro
+   * @return falsi_positivi / ricerche senza esito, 0 se non ce ne sono state
+   */
+  double falsi_positivi_osservati() const
+  {
+    unsigned long negative = prefiltrate + falsi_positivi;
+    return negative == 0 ? 0.0 : static_cast<double>(falsi_positivi) / negative;
+  }
+
+  /**
+   * @brief Funzione di stream
+   * Stampa le statistiche come coppie nome=valore su una riga
+   * @param os stream di output
+   * @param st statistiche da spedire sullo stream
+   * @return lo stream di output
+   */
+  friend std::ostream &operator<<(std::ostream &os, const statistiche_set &st)
+  {
+    os << "aggiunte=" << st.aggiunte << " duplicati=" << st.duplicati
+       << " rimozioni=" << st.rimozioni << " ricerche=" << st.ricerche
+       << " confronti=" << st.confronti
+       << " confronti_per_ricerca=" << st.confronti_per_ricerca()
+       << " allocazioni=" << st.allocazioni << " liberazioni=" << st.liberazioni
+       << " prefiltrate=" << st.prefiltrate << " falsi_positivi=" << st.falsi_positivi
+       << " byte_in_uso=" << st.byte_in_uso;
+    return os;
+  }
+};
+
+/**
+  @brief Politica senza statistiche
+
+  Politica di default di set: tutti gli eventi sono funzioni vuote che
+  il compilatore elimina, e la classe è vuota.
+*/
+struct senza_statistiche
+{
+  void aggiunta() const {}
+  void duplicato() const {}
+  void rimozione() const {}
+  void ricerca() const {}
+  void confronto() const {}
+  void allocazione() const {}
+  void liberazione(unsigned long) const {}
+  void prefiltrata() const {}
+  void falso_positivo() const {}
+
+  statistiche_set istantanea() const
+  {
+    return statistiche_set();
+  }
+};
+
+/**
+  @brief Politica con statistiche
+
+  Conta gli eventi di una set con contatori atomici aggiornati in modo
+  rilassato, così anche le ricerche concorrenti su una set costante
+  sono sicure. Copiare o assegnare la politica non copia i contatori.
+*/
+class con_statistiche
+{
+  mutable std::atomic<unsigned long> _aggiunte;
+  mutable std::atomic<unsigned long> _duplicati;
+  mutable std::atomic<unsigned long> _rimozioni;
+  mutable std::atomic<unsigned long> _ricerche;
+  mutable std::atomic<unsigned long> _confronti;
+  mutable std::atomic<unsigned long> _allocazioni;
+  mutable std::atomic<unsigned long> _liberazioni;
+  mutable std::atomic<unsigned long> _prefiltrate;
+  mutable std::atomic<unsigned long> _falsi_positivi;
+
+  static void conta(std::atomic<unsigned long> &c, unsigned long n = 1)
+  {
+    c.fetch_add(n, std::memory_order_relaxed);
+  }
+
+public:
+  /**
+   * @brief Costruttore di default
+   * @post tutti i contatori a zero
+   */
+  con_statistiche()
+      : _aggiunte(0), _duplicati(0), _rimozioni(0), _ricerche(0), _confronti(0),
+        _allocazioni(0), _liberazioni(0), _prefiltrate(0), _falsi_positivi(0) {}
+
+  /**
+   * @brief Copy constructor
+   * I contatori della nuova istanza partono da zero
+   */
+  con_statistiche(const con_statistiche &)
+      : _aggiunte(0), _duplicati(0), _rimozioni(0), _ricerche(0), _confronti(0),
+        _allocazioni(0), _liberazioni(0), _prefiltrate(0), _falsi_positivi(0) {}
+
+  /**
+   * @brief Operatore di assegnamento
+   * I contatori restano quelli di questa istanza
+   * @return reference a this
+   */
+  con_statistiche &operator=(const con_statistiche &)
+  {
+    return *this;
+  }
+
+  void aggiunta() const { conta(_aggiunte); }
+  void duplicato() const { conta(_duplicati); }
+  void rimozione() const { conta(_rimozioni); }
+  void ricerca() const { conta(_ricerche); }
+  void confronto() const { conta(_confronti); }
+  void allocazione() const { conta(_allocazioni); }
+  void liberazione(unsigned long n = 1) const { conta(_liberazioni, n); }
+  void prefiltrata() const { conta(_prefiltrate); }
+  void falso_positivo() const { conta(_falsi_positivi); }
+
+  /**
+   * @brief Valori correnti dei contatori
+   * @return istantanea dei contatori (byte_in_uso escluso)
+   */
+  statistiche_set istantanea() const
+  {
+    statistiche_set st;
+    st.aggiunte = _aggiunte.load(std::memory_order_relaxed);
+    st.duplicati = _duplicati.load(std::memory_order_relaxed);
+    st.rimozioni = _rimozioni.load(std::memory_order_relaxed);
+    st.ricerche = _ricerche.load(std::memory_order_relaxed);
+    st.confronti = _confronti.load(std::memory_order_relaxed);
+    st.allocazioni = _allocazioni.load(std::memory_order_relaxed);
+    st.liberazioni = _liberazioni.load(std::memory_order_relaxed);
+    st.prefiltrate = _prefiltrate.load(std::memory_order_relaxed);
+    st.falsi_positivi = _falsi_positivi.load(std::memory_order_relaxed);
+    return st;
+  }
+};
+
+/**
+  @brief Politica di esecuzione parallela
+
+  Passata come primo argomento a unione, intersezione e filter_out
+  indica su quanti thread dividere le ricerche e le valutazioni del
+  predicato. Per default usa tutti i core disponibili.
+*/
+struct parallelo
+{
+  unsigned int thread; ///< numero massimo di thread da usare
+
+  /**
+   * @brief Costruttore
+   * @param n numero massimo di thread (0 equivale a 1)
+   */
+  explicit parallelo(unsigned int n = std::thread::hardware_concurrency())
+      : thread(n == 0 ? 1 : n) {}
+};
+
+/**
+  @brief classe set
+
+  La classe imlementa una generica lista di elementi T.
+  La lista non può contenere elementi duplicati.
+  La valutazione se due elementi di tipo T sono uguali è realizzato
+  tramite il funtore Eql che prende due elementi a e b, e ritorna
+  verso se i due elementi sono uguali. 
+
+  Se viene passato il funtore Hash (coerente con Eql: elementi uguali
+  devono avere lo stesso hash) la set mantiene anche un indice hash sui
+  nodi, e add, cerca e remove diventano O(1) attesi. L'ordine di
+  iterazione resta quello di inserimento.
+
+  Solo con Hash i nodi memorizzano l'hash del valore, che evita di
+  ricalcolarlo e di chiamare Eql sui nodi con hash diverso; una set
+  senza Hash, anche di stringhe, confronta ogni elemento con Eql.
+
+  La politica Stats decide se contare gli eventi della set (inserimenti,
+  duplicati, ricerche, confronti, allocazioni), leggibili con stats().
+  Con senza_statistiche, il default, non costa nulla.
+
+  Con abilita_prefiltro un filtro di Bloom a conteggio davanti alle
+  ricerche respinge la maggior parte dei valori assenti senza scorrere
+  la lista o sondare l'indice.
+
+  Con N > 0 i primi N nodi stanno in un buffer dentro l'oggetto set:
+  finché ha al più N elementi la set non alloca memoria né mantiene
+  l'indice hash (la ricerca scorre la lista). Oltre N i nodi passano al
+  pool e l'indice viene costruito. Il prezzo è che spostare o scambiare
+  una set piccola sposta i suoi elementi, e l'aggiunta che supera N
+  invalida gli iteratori.
+
+*/
+template <typename T, typename Eql, typename Hash = void, typename Stats = senza_statistiche, std::size_t N = 0>
+class set : private Stats
+{
+  /**
+     * @brief Struttura nodo
+     * Struttura nodo interna che viene usata per creare la lista
+     */
+  struct nodo : set_dettagli::hash_nodo<!std::is_void<Hash>::value>
+  {
+    T valore;   ///<valore da memorizzare
+    nodo *prev; ///<puntatore al nodo precedente della lista
+    nodo *next; ///<puntatore al prossimo nodo della lista
+
+    /**
+        Costruttore di default
+        @post prev == nullptr
+        @post next == nullptr
+        */
+    nodo() : prev(nullptr), next(nullptr) {}
+
+    /**
+         * @brief Costruttore secondario
+         * Funzione che inizializza un nodo con un valore e i puntatori
+         * passati nella funzione
+         * @param v valore da copiare
+         * @param p puntatore a prev
+         * @param n puntatore a next
+         * 
+         * @post prev == p
+         * @post next == n
+           @post valore == v
+         */
+    nodo(const T &v, nodo *p, nodo *n) : valore(v), prev(p), next(n) {}
+
+    /**
+         * @brief Costruttore sul posto
+         * Funzione che inizializza un nodo costruendo il valore con gli
+         * argomenti passati, senza copie intermedie
+         * @param p puntatore a prev
+         * @param n puntatore a next
+         * @param args argomenti per il costruttore di T
+         * 
+         * @post prev == p
+         * @post next == n
+         */
+    template <typename... Args>
+    nodo(nodo *p, nodo *n, Args &&...args) : valore(std::forward<Args>(args)...), prev(p), next(n) {}
+
+    /**
+         * @brief Copy constructor
+         * Funzione che inizializza un nodo copiandio il valore e i puntatori
+         * di un altro nodo passato nella funzione
+         * @param other nodo da copiare
+         * @post valore == other.valore
+         * @post prev == other.prev
+         * @post next == other.next
+         */
+    nodo(const nodo &other) : valore(other.valore), prev(other.prev), next(other.next) {}
+    /**
+     * @brief operatore di assegnamento
+     * Funzione che copia un nodo in un altro nodo
+     * @param other nodo da copiare
+     * @return reference al nodo this 
+     */
+    nodo &operator=(const nodo &other)
+    {
+      valore = other.valore;
+      prev = other.prev;
+      next = other.next;
+      return *this;
+    }
+    /**
+      Distruttore. 
+    */
+    ~nodo() {}
+  };
+  typedef set_dettagli::indice_hash<nodo, Hash> indice;
+  typedef set_dettagli::pool_nodi<nodo> pool;
+  typedef set_dettagli::buffer_nodi<nodo, N> buffer;
+
+  nodo *_head;        ///< puntatore al primo nodo della lista (testa)
+  nodo *_tail;        ///< puntatore all'ultimo nodo della lista (coda)
+  unsigned int _size; ///< numero di elementi nella lista
+  Eql _equals;        ///< funtore per l'uguaglianza tra elementi T
+  indice _indice;     ///< indice hash sui nodi (vuoto se Hash è void)
+  pool _pool;         ///< memoria dei nodi
+  buffer _interne;    ///< nodi interni all'oggetto (vuoto se N == 0)
+  set_dettagli::impronta_set<indice::attivo> _impronta; ///< impronta degli elementi (vuota se Hash è void)
+
+  /**
+   * @brief Struttura prefiltro
+   * Filtro davanti alle ricerche con la funzione che ne calcola gli hash
+   */
+  struct prefiltro
+  {
+    set_dettagli::filtro_conteggio filtro;   ///< contatori del filtro
+    std::function<std::size_t(const T &)> hash; ///< vuota: si usa l'hash dell'indice
+
+    prefiltro(std::size_t capacita, double fp, const std::function<std::size_t(const T &)> &h)
+        : filtro(capacita, fp), hash(h) {}
+  };
+  std::unique_ptr<prefiltro> _prefiltro; ///< prefiltro, nullptr se disabilitato
+
+  // _posizioni[i] è l'i-esimo nodo della lista per ogni i < _posizioni.size().
+  // È un prefisso valido che operator[] estende quando serve: le aggiunte in
+  // coda lo lasciano valido, le rimozioni lo azzerano.
+  mutable std::vector<const nodo *> _posizioni; ///< indice posizionale dei nodi
+
+  /**
+   * @brief Politica delle statistiche
+   * @return la politica Stats da cui la set eredita
+   */
+  const Stats &contatori() const
+  {
+    return *this;
+  }
+
+  /**
+   * @brief Confronta due elementi con Eql contando il confronto
+   * @param a primo elemento
+   * @param b secondo elemento
+   * @return true se i due elementi sono uguali
+   */
+  bool uguali(const T &a, const T &b) const
+  {
+    contatori().confronto();
+    return _equals(a, b);
+  }
+
+  /**
+   * @brief Cerca il nodo che contiene un valore
+   * Usa l'indice hash se presente, altrimenti scorre la lista con Eql.
+   * @param v valore da cercare
+   * @param h hash di v calcolato dall'indice
+   * @return il nodo che contiene v, nullptr se non presente
+   */
+  nodo *trova_nodo(const T &v, std::size_t h) const
+  {
+    contatori().ricerca();
+    if (_prefiltro && !_prefiltro->filtro.forse(hash_prefiltro(v, h)))
+    {
+      contatori().prefiltrata();
+      return nullptr;
+    }
+    nodo *n = trova_nodo(v, h, std::integral_constant<bool, indice::attivo>());
+    if (n == nullptr && _prefiltro)
+      contatori().falso_positivo();
+    return n;
+  }
+
+  nodo *trova_nodo(const T &v, std::size_t h, std::true_type) const
+  {
+    if (_interne.attivo())
+    {
+      // nel buffer non c'è indice: l'hash dei nodi evita i confronti inutili
+      for (nodo *curr = _head; curr != nullptr; curr = curr->next)
+        if (curr->hash() == h && uguali(v, curr->valore))
+          return curr;
+      return nullptr;
+    }
+    return _indice.trova(v, h, [this](const T &a, const T &b) { return uguali(a, b); });
+  }
+
+  nodo *trova_nodo(const T &v, std::size_t, std::false_type) const
+  {
+    nodo *curr = _head;
+
+    while (curr != nullptr)
+    {
+      if (uguali(v, curr->valore))
+        return curr;
+      curr = curr->next;
+    }
+    return nullptr;
+  }
+
+  /**
+   * @brief Hash di un valore per il prefiltro
+   * @param v valore
+   * @param h hash di v calcolato dall'indice
+   * @return h, oppure l'hash mescolato della funzione del prefiltro se c'è
+   */
+  std::size_t hash_prefiltro(const T &v, std::size_t h) const
+  {
+    return _prefiltro->hash ? set_dettagli::mescola(_prefiltro->hash(v)) : h;
+  }
+
+  /**
+   * @brief Ridimensiona il prefiltro se non basta per n elementi
+   * Il nuovo filtro ha capacità doppia e viene riempito con gli
+   * elementi presenti; se fallisce resta quello vecchio.
+   * @param n elementi che il prefiltro deve contenere
+   */
+  void cresci_prefiltro(std::size_t n)
+  {
+    if (n <= _prefiltro->filtro.capacita())
+      return;
+    std::unique_ptr<prefiltro> nuovo(new prefiltro(std::max(n, 2 * _prefiltro->filtro.capacita()),
+                                                   _prefiltro->filtro.obiettivo(), _prefiltro->hash));
+    for (nodo *curr = _head; curr != nullptr; curr = curr->next)
+      nuovo->filtro.aggiungi(nuovo->hash ? set_dettagli::mescola(nuovo->hash(curr->valore))
+                                          : curr->hash());
+    _prefiltro.swap(nuovo);
+  }
+
+  /**
+   * @brief Toglie un nodo dall'indice hash e dal prefiltro
+   * @param n nodo da togliere
+   * @param h hash del valore del nodo
+   */
+  void disindicizza(nodo *n, std::size_t h)
+  {
+    if (_prefiltro)
+      _prefiltro->filtro.togli(hash_prefiltro(n->valore, h));
+    if (!_interne.interna(n))
+      _indice.rimuovi(n, h);
+  }
+
+  /**
+   * @brief Inserisce in coda un valore non presente nella set
+   * @param v valore da inserire (copiato o spostato)
+   * @param h hash di v calcolato dall'indice
+   * @post _size = _size+1
+   */
+  template <typename V>
+  void accoda(V &&v, std::size_t h)
+  {
+    collega(crea_nodo(_tail, nullptr, std::forward<V>(v)), h);
+  }
+
+  /**
+   * @brief Aggiunge un valore se non è già presente
+   * @param v valore da inserire (copiato o spostato)
+   */
+  template <typename V>
+  void aggiungi(V &&v)
+  {
+    std::size_t h = _indice.calcola(v);
+
+    if (trova_nodo(v, h) != nullptr)
+    {
+      contatori().duplicato();
+      return;
+    }
+    accoda(std::forward<V>(v), h);
+  }
+
+  /**
+   * @brief Indicizza un nodo appena creato e lo collega in coda
+   * Se l'indicizzazione fallisce il nodo viene distrutto e l'eccezione
+   * rilanciata.
+   * @param tmp nodo da collegare, con next == nullptr
+   * @param h hash del valore del nodo
+   * @post _size = _size+1
+   */
+  void collega(nodo *tmp, std::size_t h)
+  {
+    // crea_nodo può aver spostato i nodi fuori dal buffer
+    tmp->prev = _tail;
+    tmp->memorizza(h);
+    std::size_t hp = 0;
+    try
+    {
+      if (_prefiltro)
+      {
+        cresci_prefiltro(_size + 1);
+        hp = hash_prefiltro(tmp->valore, h);
+      }
+      if (!_interne.interna(tmp))
+        _indice.inserisci(tmp, h);
+    }
+    catch (...)
+    {
+      distruggi_nodo(tmp);
+      throw;
+    }
+    if (_prefiltro)
+      _prefiltro->filtro.aggiungi(hp);
+    _impronta.aggiungi(h);
+    if (_tail == nullptr)
+      _head = tmp;
+    else
+      _tail->next = tmp;
+    _tail = tmp;
+    _size++;
+    contatori().aggiunta();
+  }
+
+  /**
+   * @brief Costruisce un nodo nel buffer interno o nella memoria del pool
+   * Se il buffer è attivo ma pieno i nodi vengono prima spostati nel
+   * pool, quindi p non è più valido: collega rimette prev a _tail.
+   * @param p puntatore a prev
+   * @param n puntatore a next
+   * @param args argomenti per il costruttore del valore
+   * @return il nodo costruito
+   */
+  template <typename... Args>
+  nodo *crea_nodo(nodo *p, nodo *n, Args &&...args)
+  {
+    if (_interne.attivo() && _interne.pieno())
+    {
+      trasloca();
+      p = _tail;
+    }
+    bool interno = _interne.attivo();
+    void *m = interno ? _interne.prendi() : _pool.prendi();
+    try
+    {
+      nodo *tmp = new (m) nodo(p, n, std::forward<Args>(args)...);
+      contatori().allocazione();
+      return tmp;
+    }
+    catch (...)
+    {
+      libera_cella(m);
+      throw;
+    }
+  }
+
+  // Restituisce la memoria di un nodo al buffer o al pool
+  void libera_cella(void *m)
+  {
+    if (_interne.interna(m))
+      _interne.libera(m);
+    else
+      _pool.libera(m);
+  }
+
+  /**
+   * @brief Distrugge un nodo e ne restituisce la memoria
+   * @param n nodo da distruggere
+   */
+  void distruggi_nodo(nodo *n)
+  {
+    n->~nodo();
+    libera_cella(n);
+    contatori().liberazione(1);
+  }
+
+  /**
+   * @brief Sposta i nodi dal buffer interno al pool
+   * I valori vengono spostati (copiati se lo spostamento può lanciare)
+   * in nodi nuovi, che vengono indicizzati; poi il buffer viene
+   * disattivato. Se qualcosa fallisce la set resta com'era.
+   */
+  void trasloca()
+  {
+    if (_size == 0)
+    {
+      _interne.disattiva();
+      return;
+    }
+    _indice.riserva(_size + 1);
+    _pool.riserva(_size);
+    nodo *testa = nullptr;
+    nodo *coda = nullptr;
+    try
+    {
+      for (nodo *curr = _head; curr != nullptr; curr = curr->next)
+      {
+        nodo *tmp = new (_pool.prendi()) nodo(coda, nullptr, std::move_if_noexcept(curr->valore));
+        if (coda == nullptr)
+          testa = tmp;
+        else
+          coda->next = tmp;
+        coda = tmp;
+        tmp->memorizza(curr->hash());
+        _indice.inserisci(tmp, tmp->hash());
+      }
+    }
+    catch (...)
+    {
+      _indice.svuota();
+      while (testa != nullptr)
+      {
+        nodo *tnext = testa->next;
+        testa->~nodo();
+        _pool.libera(testa);
+        testa = tnext;
+      }
+      throw;
+    }
+    distruggi_valori(std::is_trivially_destructible<T>());
+    _interne.disattiva();
+    _head = testa;
+    _tail = coda;
+    _posizioni.clear();
+  }
+
+  /**
+   * @brief Dimensiona l'indice per un numero di elementi
+   * Se gli elementi non staranno nel buffer interno i nodi vengono
+   * spostati subito nel pool; finché il buffer basta l'indice non serve.
+   * @param totale numero di elementi previsto
+   */
+  void riserva_indice(std::size_t totale)
+  {
+    if (_interne.attivo())
+    {
+      if (totale <= N)
+        return;
+      trasloca();
+    }
+    _indice.riserva(totale);
+  }
+
+  /**
+   * @brief Prepara la memoria del pool per n nodi
+   * Da chiamare dopo riserva_indice: con il buffer attivo non serve.
+   * @param n numero di nodi previsto
+   */
+  void riserva_nodi(std::size_t n)
+  {
+    if (!_interne.attivo())
+      _pool.riserva(n);
+  }
+
+  /**
+   * @brief Stacca un nodo dalla lista e lo distrugge
+   * @param n nodo da eliminare, deve essere già stato tolto dall'indice
+   * @post _size = _size-1
+   */
+  void elimina(nodo *n)
+  {
+    _posizioni.clear();
+    _impronta.togli(n->hash());
+    if (n->prev == nullptr)
+      _head = n->next;
+    else
+      n->prev->next = n->next;
+    if (n->next == nullptr)
+      _tail = n->prev;
+    else
+      n->next->prev = n->prev;
+    distruggi_nodo(n);
+    _size--;
+    if (_size == 0)
+      _interne.azzera();
+  }
+
+  /**
+   * @brief Scambia il contenuto di due set
+   * @param other set con cui scambiare
+   */
+  void scambia(set &other)
+  {
+    if (nel_buffer() || other.nel_buffer())
+    {
+      set tmp;
+      tmp.prendi_da(*this);
+      prendi_da(other);
+      other.prendi_da(tmp);
+      return;
+    }
+    std::swap(_head, other._head);
+    std::swap(_tail, other._tail);
+    std::swap(_size, other._size);
+    std::swap(_equals, other._equals);
+    _indice.scambia(other._indice);
+    _pool.scambia(other._pool);
+    _interne.scambia(other._interne);
+    std::swap(_impronta, other._impronta);
+    _prefiltro.swap(other._prefiltro);
+    _posizioni.swap(other._posizioni);
+  }
+
+  // true se la set ha nodi nel buffer interno
+  bool nel_buffer() const
+  {
+    return _interne.attivo() && _size != 0;
+  }
+
+  /**
+   * @brief Prende il contenuto di un'altra set, che resta vuota
+   * I nodi nel pool passano per puntatore; quelli nel buffer interno di
+   * other vengono ricostruiti nel buffer di questa set spostandone i
+   * valori, quindi lo spostamento di T non deve lanciare eccezioni.
+   * @param other set da cui prendere il contenuto
+   * @pre questa set è vuota
+   */
+  void prendi_da(set &other) noexcept
+  {
+    if (!other.nel_buffer())
+    {
+      scambia(other);
+      return;
+    }
+    std::swap(_equals, other._equals);
+    _indice.scambia(other._indice);
+    _pool.scambia(other._pool);
+    _prefiltro.swap(other._prefiltro);
+    std::swap(_impronta, other._impronta);
+    _interne.azzera();
+    for (nodo *curr = other._head; curr != nullptr; curr = curr->next)
+    {
+      nodo *tmp = new (_interne.prendi()) nodo(_tail, nullptr, std::move(curr->valore));
+      tmp->memorizza(curr->hash());
+      if (_tail == nullptr)
+        _head = tmp;
+      else
+        _tail->next = tmp;
+      _tail = tmp;
+      _size++;
+    }
+    other.distruggi_valori(std::is_trivially_destructible<T>());
+    other._head = nullptr;
+    other._tail = nullptr;
+    other._size = 0;
+    other._interne.azzera();
+    other._posizioni.clear();
+  }
+
+  /**
+   * @brief Accoda gli elementi marcati di una sequenza senza duplicati
+   * La sequenza non deve contenere elementi già presenti nella set,
+   * quindi gli elementi vengono accodati senza ricerche.
+   * @param b iteratore di inizio della sequenza
+   * @param marcati per ogni elemento della sequenza, 1 se va accodato
+   */
+  template <typename It>
+  void accoda_marcati(It b, const std::vector<char> &marcati)
+  {
+    for (std::size_t i = 0; i < marcati.size(); ++i, ++b)
+      if (marcati[i])
+        accoda(*b, _indice.calcola(*b));
+  }
+
+  /**
+   * @brief Rimuove i nodi i cui valori soddisfano un predicato
+   * Una sola passata sulla lista, senza ricerche
+   * @param predicato predicato da applicare ai valori
+   * @return il numero di elementi rimossi
+   */
+  template <typename P>
+  unsigned int rimuovi_se(P predicato)
+  {
+    return rimuovi_nodi_se([&predicato](const nodo *n) { return predicato(n->valore); });
+  }
+
+  /**
+   * @brief Rimuove i nodi che soddisfano un predicato
+   * Come rimuovi_se, ma il predicato riceve il nodo, quindi può usarne
+   * l'hash memorizzato
+   * @param predicato predicato da applicare ai nodi
+   * @return il numero di elementi rimossi
+   */
+  template <typename P>
+  unsigned int rimuovi_nodi_se(P predicato)
+  {
+    unsigned int prima = _size;
+    nodo *curr = _head;
+
+    while (curr != nullptr)
+    {
+      nodo *cnext = curr->next;
+      if (predicato(curr))
+      {
+        disindicizza(curr, curr->hash());
+        elimina(curr);
+        contatori().rimozione();
+      }
+      curr = cnext;
+    }
+    return prima - _size;
+  }
+
+  /**
+   * @brief Cerca il valore di un nodo di un'altra set dello stesso tipo
+   * Usa l'hash memorizzato nel nodo invece di ricalcolarlo
+   * @param n nodo di un'altra set
+   * @return true se il valore di n è presente
+   */
+  bool contiene(const nodo *n) const
+  {
+    return trova_nodo(n->valore, n->hash()) != nullptr;
+  }
+
+  /**
+   * @brief Distrugge i valori di tutti i nodi
+   * Se T ha un distruttore banale non c'è niente da fare e la lista
+   * non viene nemmeno percorsa.
+   */
+  void distruggi_valori(std::true_type) {}
+
+  void distruggi_valori(std::false_type)
+  {
+    nodo *curr = _head;
+
+    while (curr != nullptr)
+    {
+      nodo *cnext = curr->next;
+      curr->~nodo();
+      curr = cnext;
+    }
+  }
+
+public:
+  /**
+   * @brief Costruttore di default
+   * Funzione che inizializza una set
+   * @post _head == nullptr
+     @post _size == 0
+ */
+  set() : _head(nullptr), _tail(nullptr), _size(0) {}
+
+  /**
+   * @brief Costruttore con arena
+   * Funzione che inizializza una set i cui nodi vengono allocati
+   * dall'arena passata. L'arena deve sopravvivere alla set.
+   * @param a arena da cui allocare i nodi
+   * @post _head == nullptr
+     @post _size == 0
+   */
+  explicit set(arena &a) : _head(nullptr), _tail(nullptr), _size(0), _pool(&a) {}
+  /**
+ * @brief Copy constructor
+ * Funzione che inizializza una set copiando i dati di un altra set
+ * passata nella funzione. I contatori di Stats sono della singola set e
+ * non vengono copiati: la copia conta solo le proprie operazioni.
+ * @param other lista da copiare
+ * @post _size = other._size
+ */
+  set(const set &other) : Stats(), _head(nullptr), _tail(nullptr), _size(0)
+  {
+    copia(other);
+  }
+
+  /**
+   * @brief Copy constructor con arena
+   * Come il copy constructor, ma i nodi della copia vengono allocati
+   * dall'arena passata
+   * @param other lista da copiare
+   * @param a arena da cui allocare i nodi
+   * @post _size = other._size
+   */
+  set(const set &other, arena &a) : Stats(), _head(nullptr), _tail(nullptr), _size(0), _pool(&a)
+  {
+    copia(other);
+  }
+
+  /**
+   * @brief Move constructor
+   * Funzione che inizializza una set prendendo i nodi di un'altra set,
+   * che resta vuota. Se la set di origine usava un'arena, la usa ora
+   * questa set.
+   * @param other set da cui prendere i nodi
+   * @post other._size == 0
+   */
+  set(set &&other) noexcept : _head(nullptr), _tail(nullptr), _size(0)
+  {
+    prendi_da(other);
+  }
+
+private:
+  /**
+   * @brief Copia gli elementi di un'altra set in questa set vuota
+   * In caso di eccezione la set viene svuotata e l'eccezione rilanciata
+   * @param other set da copiare
+   */
+  void copia(const set &other)
+  {
+    nodo *curr = other._head;
+    try
+    {
+      if (other._prefiltro)
+        _prefiltro.reset(new prefiltro(std::max<std::size_t>(other._size, other._prefiltro->filtro.capacita()),
+                                       other._prefiltro->filtro.obiettivo(), other._prefiltro->hash));
+      // gli elementi di other sono distinti: si accodano senza ricerche
+      riserva_indice(other._size);
+      riserva_nodi(other._size);
+      while (curr != nullptr)
+      {
+        accoda(curr->valore, curr->hash());
+        curr = curr->next;
+      }
+    }
+    catch (...)
+    {
+      svuota();
+      throw;
+    }
+  }
+
+  /**
+   * @brief Costruttore con sorgente dei nodi
+   * @param a arena da cui allocare i nodi, nullptr per usare il sistema
+   */
+  explicit set(arena *a) : _head(nullptr), _tail(nullptr), _size(0), _pool(a) {}
+
+public:
+  /**
+    * @brief 
+    * 
+    * @param other 
+    * @return set& 
+    */
+
+  /**
+   * @brief Operatore di assegnamento
+   * Funzione che copia una set in un altra set
+   * @param other lista da copiare
+   * @return reference alla lista this
+   */
+  set &operator=(const set &other)
+  {
+    if (this != &other)
+    {
+      set tmp(_pool.sorgente());
+      tmp.copia(other);
+      scambia(tmp);
+    }
+    return *this;
+  }
+
+  /**
+   * @brief Operatore di assegnamento per spostamento
+   * Funzione che libera la set e prende i nodi di un'altra set,
+   * che resta vuota
+   * @param other set da cui prendere i nodi
+   * @return reference alla lista this
+   */
+  set &operator=(set &&other) noexcept
+  {
+    if (this != &other)
+    {
+      set tmp(std::move(other));
+      scambia(tmp);
+    }
+    return *this;
+  }
+  /**
+    Distruttore 
+    @post _head == nullptr
+    @post _size == 0
+  */
+  ~set()
+  {
+    svuota();
+  }
+  /**
+   * @brief Svuota la lista
+   * I blocchi dei nodi vengono restituiti in una volta sola; la lista
+   * viene percorsa solo se T ha un distruttore da chiamare.
+   * @post _head == nullptr
+     @post _size == 0
+   */
+  void svuota()
+  {
+    distruggi_valori(std::is_trivially_destructible<T>());
+    _pool.rilascia();
+    _interne.azzera();
+    _impronta.azzera();
+    contatori().liberazione(_size);
+    _size = 0;
+    _head = nullptr;
+    _tail = nullptr;
+    _indice.svuota();
+    if (_prefiltro)
+      _prefiltro->filtro.svuota();
+    std::vector<const nodo *>().swap(_posizioni);
+  }
+  /**
+   * @brief Funzione per vedere se una set è vuota
+   * 
+   * @return true se la lista è vuota
+   * @return false altrimenti
+   */
+    bool is_empty() const {
+    return _size == 0;
+  }
+  /**
+    * @brief 
+    * Aggiunge un elemento nella lista evitando i duplicati
+    * tramite il funtore di tipo Eql.
+    * @param v valore da inserire nella lista
+    * @post _size = _size+1
+    */
+  void add(const T &v)
+  {
+    aggiungi(v);
+  }
+
+  /**
+    * @brief 
+    * Aggiunge un elemento nella lista spostandone il valore,
+    * evitando i duplicati tramite il funtore di tipo Eql.
+    * Se il valore è già presente non viene spostato.
+    * @param v valore da inserire nella lista
+    * @post _size = _size+1
+    */
+  void add(T &&v)
+  {
+    aggiungi(std::move(v));
+  }
+
+  /**
+    * @brief 
+    * Costruisce un elemento direttamente nel nodo della lista a partire
+    * dagli argomenti passati. Se l'elemento risulta già presente
+    * (tramite il funtore di tipo Eql) viene distrutto.
+    * @param args argomenti per il costruttore di T
+    * @post _size = _size+1
+    */
+  template <typename... Args>
+  void emplace(Args &&...args)
+  {
+    nodo *tmp = crea_nodo(_tail, nullptr, std::forward<Args>(args)...);
+    std::size_t h;
+    bool presente;
+    try
+    {
+      h = _indice.calcola(tmp->valore);
+      presente = trova_nodo(tmp->valore, h) != nullptr;
+    }
+    catch (...)
+    {
+      distruggi_nodo(tmp);
+      throw;
+    }
+    if (presente)
+    {
+      distruggi_nodo(tmp);
+      contatori().duplicato();
+      return;
+    }
+    collega(tmp, h);
+  }
+
+  /**
+   * @brief Dimensione lista
+   * Ritorna il numero di elementi nella lista
+   * @return il numero di elementi nella lista
+   */
+  unsigned int size() const
+  {
+    return _size;
+  }
+
+  /**
+   * @brief Statistiche della set
+   * Ritorna i contatori della politica Stats e la memoria occupata
+   * dai blocchi dei nodi e dagli indici
+   * @return istantanea delle statistiche
+   */
+  statistiche_set stats() const
+  {
+    statistiche_set st = contatori().istantanea();
+    st.byte_in_uso = _pool.byte() + _indice.byte() + _posizioni.capacity() * sizeof(const nodo *);
+    if (_prefiltro)
+      st.byte_in_uso += _prefiltro->filtro.byte();
+    return st;
+  }
+
+  /**
+   * @brief Abilita il prefiltro usando l'hash dell'indice
+   * Disponibile solo se Hash non è void. Se il prefiltro era già
+   * abilitato viene ricostruito con il nuovo tasso.
+   * @param fp tasso di falsi positivi voluto (0 < fp < 1)
+   */
+  void abilita_prefiltro(double fp = 0.01)
+  {
+    static_assert(indice::attivo, "senza Hash passare ad abilita_prefiltro una funzione di hash");
+    abilita_prefiltro(fp, std::function<std::size_t(const T &)>());
+  }
+
+  /**
+   * @brief Abilita il prefiltro con una funzione di hash
+   * Permette il prefiltro anche senza indice hash; la funzione deve
+   * essere coerente con Eql. Il filtro si ridimensiona da solo quando
+   * la set cresce, mantenendo il tasso voluto.
+   * @param fp tasso di falsi positivi voluto (0 < fp < 1)
+   * @param hash funzione di hash degli elementi
+   */
+  void abilita_prefiltro(double fp, const std::function<std::size_t(const T &)> &hash)
+  {
+    assert(hash || indice::attivo);
+    std::unique_ptr<prefiltro> nuovo(new prefiltro(std::max<std::size_t>(2 * _size, 64), fp, hash));
+    for (nodo *curr = _head; curr != nullptr; curr = curr->next)
+      nuovo->filtro.aggiungi(hash ? set_dettagli::mescola(hash(curr->valore)) : curr->hash());
+    _prefiltro.swap(nuovo);
+  }
+
+  /**
+   * @brief Disabilita il prefiltro e ne libera la memoria
+   */
+  void disabilita_prefiltro()
+  {
+    _prefiltro.reset();
+  }
+
+  /**
+   * @brief Tasso di falsi positivi stimato del prefiltro
+   * Stima per il numero attuale di elementi; il tasso osservato è in
+   * stats().falsi_positivi_osservati() con la politica con_statistiche.
+   * @return la stima, 0 se il prefiltro è disabilitato
+   */
+  double falsi_positivi_prefiltro() const
+  {
+    return _prefiltro ? _prefiltro->filtro.stima(_size) : 0.0;
+  }
+
+  /**
+   * @brief Rimuovi
+   * Funzione che permette di rimuovere un valore passatogli dalla lista
+   * @param v valore da rimuovere
+   */
+  void remove(const T &v)
+  {
+    std::size_t h = _indice.calcola(v);
+    nodo *curr = trova_nodo(v, h);
+
+    if (curr == nullptr)
+      return;
+    disindicizza(curr, h);
+    elimina(curr);
+    contatori().rimozione();
+  }
+
+  /**
+   * @brief Costruttore iteratore
+   * Costruttore che crea una set riempita con dati
+     presi da una sequenza identificata da un iteratore di 
+     inizio e uno di fine. Gli iteratori possono essere di
+     qualunque tipo.  
+   * @param b iteratore di inizio
+   * @param e iteratore di fine
+   */
+  template <typename Q>
+  set(Q b, Q e) : _head(nullptr), _tail(nullptr), _size(0)
+  {
+    // in caso di errore insert toglie i nodi aggiunti, quindi la lista
+    // resta vuota e non c'è altro da liberare
+    insert(b, e);
+  }
+
+  /**
+   * @brief Inserimento di una sequenza
+   * Aggiunge gli elementi di una sequenza identificata da un iteratore
+   * di inizio e uno di fine, scartando i duplicati tramite Eql.
+   * Se gli iteratori permettono di conoscere la lunghezza della sequenza
+   * l'indice e i nodi vengono preallocati in una volta. Con l'indice
+   * hash il costo è lineare nella lunghezza della sequenza.
+   * Se un inserimento fallisce vengono tolti tutti gli elementi aggiunti
+   * e la set torna com'era.
+   * @param b iteratore di inizio
+   * @param e iteratore di fine
+   */
+  template <typename Q>
+  void insert(Q b, Q e)
+  {
+    riserva_sequenza(b, e, typename std::iterator_traits<Q>::iterator_category());
+    unsigned int vecchia_size = _size;
+    try
+    {
+      for (; b != e; ++b)
+      {
+        T v(static_cast<T>(*b));
+        std::size_t h = _indice.calcola(v);
+        if (trova_nodo(v, h) == nullptr)
+          accoda(std::move(v), h);
+        else
+          contatori().duplicato();
+      }
+    }
+    catch (...)
+    {
+      togli_dopo(vecchia_size);
+      throw;
+    }
+  }
+
+  /**
+   * @brief Cerca molti valori insieme
+   * Con l'indice hash gli hash vengono calcolati prima, e mentre si cerca
+   * una chiave si precaricano lo slot e il nodo di quelle successive, così
+   * le attese sulla memoria si sovrappongono. Senza indice la lista viene
+   * percorsa una volta sola per tutte le chiavi.
+   * @param b iteratore (almeno forward) di inizio delle chiavi, di tipo T
+   * @param e iteratore di fine
+   * @return per ogni chiave, nell'ordine, true se è presente
+   */
+  template <typename Q>
+  std::vector<bool> cerca_batch(Q b, Q e) const
+  {
+    std::vector<bool> esito;
+    cerca_batch(b, e, esito, std::integral_constant<bool, indice::attivo>());
+    return esito;
+  }
+
+  /**
+   * @brief Aggiunge molti valori insieme
+   * Come insert, ma con le ricerche organizzate come in cerca_batch:
+   * l'indice viene dimensionato in anticipo e le chiavi precaricate, e
+   * senza indice i duplicati con la set si trovano in una passata.
+   * Se un inserimento fallisce la set torna com'era.
+   * @param b iteratore (almeno forward) di inizio delle chiavi, di tipo T
+   * @param e iteratore di fine
+   */
+  template <typename Q>
+  void add_batch(Q b, Q e)
+  {
+    add_batch(b, e, std::integral_constant<bool, indice::attivo>());
+  }
+
+  /**
+   * @brief Rimuove molti valori insieme
+   * Con le ricerche organizzate come in cerca_batch. Le chiavi assenti
+   * vengono ignorate.
+   * @param b iteratore (almeno forward) di inizio delle chiavi, di tipo T
+   * @param e iteratore di fine
+   */
+  template <typename Q>
+  void remove_batch(Q b, Q e)
+  {
+    remove_batch(b, e, std::integral_constant<bool, indice::attivo>());
+  }
+
+private:
+  /**
+   * @brief Prealloca indice e nodi per una sequenza di lunghezza nota
+   * @param b iteratore di inizio
+   * @param e iteratore di fine
+   */
+  template <typename Q>
+  void riserva_sequenza(Q b, Q e, std::forward_iterator_tag)
+  {
+    std::size_t n = static_cast<std::size_t>(std::distance(b, e));
+    riserva_indice(_size + n);
+    riserva_nodi(n);
+    if (_prefiltro)
+      cresci_prefiltro(_size + n);
+  }
+
+  // Con iteratori di input la lunghezza non è nota prima di scorrerli
+  template <typename Q>
+  void riserva_sequenza(Q, Q, std::input_iterator_tag) {}
+
+  /**
+   * @brief Toglie i nodi accodati dopo i primi vecchia_size
+   * Lavora sul numero di nodi e non su un nodo, perché i nodi possono
+   * essere stati spostati fuori dal buffer interno nel frattempo.
+   * @param vecchia_size numero di nodi da tenere
+   */
+  void togli_dopo(unsigned int vecchia_size)
+  {
+    while (_size > vecchia_size)
+    {
+      nodo *n = _tail;
+      disindicizza(n, n->hash());
+      elimina(n);
+    }
+  }
+
+  /**
+   * @brief Calcola gli hash di una sequenza di chiavi
+   * @param b iteratore di inizio
+   * @param e iteratore di fine
+   * @param h hash mescolati, nell'ordine delle chiavi
+   */
+  template <typename Q>
+  void calcola_hash(Q b, Q e, std::vector<std::size_t> &h) const
+  {
+    for (; b != e; ++b)
+      h.push_back(_indice.calcola(*b));
+  }
+
+  /**
+   * @brief Precarica l'indice per le chiavi successive alla i-esima
+   * Lo slot della chiave a distanza 2D e il nodo di quella a distanza D,
+   * con D = distanza_precarica: quando la ricerca arriva a una chiave,
+   * slot e nodo sono già in cache.
+   * @param h hash delle chiavi
+   * @param i chiave che sta per essere cercata
+   */
+  void precarica_chiavi(const std::vector<std::size_t> &h, std::size_t i) const
+  {
+    const std::size_t d = set_dettagli::distanza_precarica;
+    if (i == 0)
+    {
+      for (std::size_t j = 0; j < 2 * d && j < h.size(); ++j)
+        _indice.precarica(h[j]);
+      for (std::size_t j = 0; j < d && j < h.size(); ++j)
+        _indice.precarica_nodo(h[j]);
+    }
+    if (i + 2 * d < h.size())
+      _indice.precarica(h[i + 2 * d]);
+    if (i + d < h.size())
+      _indice.precarica_nodo(h[i + d]);
+  }
+
+  /**
+   * @brief Cerca molte chiavi in una sola passata sulla lista
+   * Ogni nodo viene confrontato con le chiavi non ancora trovate; la
+   * passata si ferma quando sono state trovate tutte. Le chiavi respinte
+   * dal prefiltro non partecipano alla passata.
+   * @param chiavi chiavi da cercare
+   * @param trovati per ogni chiave il nodo che la contiene, nullptr se assente
+   */
+  void trova_in_una_passata(const std::vector<const T *> &chiavi, std::vector<nodo *> &trovati) const
+  {
+    std::vector<std::size_t> aperte;
+    trovati.assign(chiavi.size(), nullptr);
+    for (std::size_t i = 0; i < chiavi.size(); ++i)
+    {
+      contatori().ricerca();
+      if (_prefiltro && !_prefiltro->filtro.forse(hash_prefiltro(*chiavi[i], 0)))
+        contatori().prefiltrata();
+      else
+        aperte.push_back(i);
+    }
+    for (nodo *curr = _head; curr != nullptr && !aperte.empty(); curr = curr->next)
+    {
+      for (std::size_t j = 0; j < aperte.size();)
+      {
+        if (uguali(*chiavi[aperte[j]], curr->valore))
+        {
+          trovati[aperte[j]] = curr;
+          aperte[j] = aperte.back();
+          aperte.pop_back();
+        }
+        else
+          ++j;
+      }
+    }
+    if (_prefiltro)
+      for (std::size_t j = 0; j < aperte.size(); ++j)
+        contatori().falso_positivo();
+  }
+
+  /**
+   * @brief Indirizzi delle chiavi di una sequenza
+   * @param b iteratore di inizio
+   * @param e iteratore di fine
+   * @param chiavi puntatori agli elementi della sequenza
+   */
+  template <typename Q>
+  static void indirizzi(Q b, Q e, std::vector<const T *> &chiavi)
+  {
+    for (; b != e; ++b)
+    {
+      const T &v = *b;
+      chiavi.push_back(&v);
+    }
+  }
+
+  template <typename Q>
+  void cerca_batch(Q b, Q e, std::vector<bool> &esito, std::true_type) const
+  {
+    std::vector<std::size_t> h;
+    calcola_hash(b, e, h);
+    esito.assign(h.size(), false);
+    for (std::size_t i = 0; i < h.size(); ++i, ++b)
+    {
+      precarica_chiavi(h, i);
+      esito[i] = trova_nodo(*b, h[i]) != nullptr;
+    }
+  }
+
+  template <typename Q>
+  void cerca_batch(Q b, Q e, std::vector<bool> &esito, std::false_type) const
+  {
+    std::vector<const T *> chiavi;
+    std::vector<nodo *> trovati;
+    indirizzi(b, e, chiavi);
+    trova_in_una_passata(chiavi, trovati);
+    esito.assign(chiavi.size(), false);
+    for (std::size_t i = 0; i < trovati.size(); ++i)
+      esito[i] = trovati[i] != nullptr;
+  }
+
+  template <typename Q>
+  void add_batch(Q b, Q e, std::true_type)
+  {
+    std::vector<std::size_t> h;
+    calcola_hash(b, e, h);
+    // con l'indice già dimensionato gli slot precaricati restano validi
+    riserva_indice(_size + h.size());
+    if (_prefiltro)
+      cresci_prefiltro(_size + h.size());
+    unsigned int vecchia_size = _size;
+    try
+    {
+      for (std::size_t i = 0; i < h.size(); ++i, ++b)
+      {
+        precarica_chiavi(h, i);
+        if (trova_nodo(*b, h[i]) == nullptr)
+          accoda(*b, h[i]);
+        else
+          contatori().duplicato();
+      }
+    }
+    catch (...)
+    {
+      togli_dopo(vecchia_size);
+      throw;
+    }
+  }
+
+  template <typename Q>
+  void add_batch(Q b, Q e, std::false_type)
+  {
+    std::vector<const T *> chiavi;
+    std::vector<nodo *> trovati;
+    indirizzi(b, e, chiavi);
+    trova_in_una_passata(chiavi, trovati);
+    // dopo riserva_indice i nodi non si spostano più, e vecchia_coda resta valido
+    riserva_indice(_size + chiavi.size());
+    nodo *vecchia_coda = _tail;
+    unsigned int vecchia_size = _size;
+    try
+    {
+      for (std::size_t i = 0; i < chiavi.size(); ++i)
+      {
+        // le chiavi assenti dalla set vanno confrontate solo con
+        // quelle accodate da questo batch
+        nodo *curr = trovati[i];
+        if (curr == nullptr)
+          for (curr = vecchia_coda == nullptr ? _head : vecchia_coda->next; curr != nullptr; curr = curr->next)
+            if (uguali(*chiavi[i], curr->valore))
+              break;
+        if (curr == nullptr)
+          accoda(*chiavi[i], 0);
+        else
+          contatori().duplicato();
+      }
+    }
+    catch (...)
+    {
+      togli_dopo(vecchia_size);
+      throw;
+    }
+  }
+
+  template <typename Q>
+  void remove_batch(Q b, Q e, std::true_type)
+  {
+    std::vector<std::size_t> h;
+    calcola_hash(b, e, h);
+    for (std::size_t i = 0; i < h.size(); ++i, ++b)
+    {
+      precarica_chiavi(h, i);
+      nodo *n = trova_nodo(*b, h[i]);
+      if (n != nullptr)
+      {
+        disindicizza(n, h[i]);
+        elimina(n);
+        contatori().rimozione();
+      }
+    }
+  }
+
+  template <typename Q>
+  void remove_batch(Q b, Q e, std::false_type)
+  {
+    std::vector<const T *> chiavi;
+    std::vector<nodo *> trovati;
+    indirizzi(b, e, chiavi);
+    trova_in_una_passata(chiavi, trovati);
+    // chiavi ripetute trovano lo stesso nodo, che va eliminato una volta
+    trovati.erase(std::remove(trovati.begin(), trovati.end(), static_cast<nodo *>(nullptr)), trovati.end());
+    std::sort(trovati.begin(), trovati.end(), std::less<nodo *>());
+    trovati.erase(std::unique(trovati.begin(), trovati.end()), trovati.end());
+    for (std::size_t i = 0; i < trovati.size(); ++i)
+    {
+      disindicizza(trovati[i], 0);
+      elimina(trovati[i]);
+      contatori().rimozione();
+    }
+  }
+
+public:
+
+  /**
+   * @brief Funzione di stream
+   * Funzione GLOBALE che implementa l'operatore di stream.
+     La funzione è templata sulla sett ed è messa
+     friend perchè accediamo ai dati privati di set.
+   * @param os stream di output
+   * @param s set da spedire sullo stream
+   * @return lo stream di output 
+   */
+  friend std::ostream &operator<<(std::ostream &os, const set &s)
+  {
+    return s.write_to(os);
+  }
+
+  /**
+   * @brief Scrive gli elementi su uno stream
+   * Ogni elemento è seguito dal separatore. Con i flag di formato di
+   * default interi, virgola mobile e stringhe vengono formattati in un
+   * buffer scritto sullo stream a blocchi; gli altri tipi usano il loro
+   * operator<<. Il testo prodotto è lo stesso di os << elemento << sep.
+   * @param os stream di output
+   * @param sep separatore scritto dopo ogni elemento
+   * @return lo stream di output
+   */
+  std::ostream &write_to(std::ostream &os, const char *sep = " ") const
+  {
+    if (!set_dettagli::formato_di_default(os))
+    {
+      for (nodo *curr = _head; curr != nullptr; curr = curr->next)
+        os << curr->valore << sep;
+      return os;
+    }
+    std::size_t n_sep = std::char_traits<char>::length(sep);
+    set_dettagli::buffer_testo b(os);
+    for (nodo *curr = _head; curr != nullptr; curr = curr->next)
+    {
+      set_dettagli::formato_testo<T>::scrivi(b, curr->valore);
+      b.scrivi(sep, n_sep);
+    }
+    return os;
+  }
+
+private:
+  template <typename, typename, typename, typename>
+  friend class espressione_set;
+  template <typename, typename, typename>
+  friend class mapped_set;
+
+  /**
+   * @brief Accoda una sequenza di valori distinti e non presenti
+   * Con il buffer interno n è solo un limite: i valori riempiono prima il
+   * buffer, e pool e indice vengono dimensionati solo se la sequenza non
+   * ci sta davvero.
+   * @param b iteratore di inizio
+   * @param e iteratore di fine
+   * @param n limite superiore alla lunghezza, per dimensionare l'indice
+   */
+  template <typename It>
+  void accoda_sequenza(It b, It e, std::size_t n)
+  {
+    if (_interne.attivo() && _size + n > N)
+    {
+      for (; b != e && !_interne.pieno(); ++b)
+        accoda(*b, _indice.calcola(*b));
+      if (b == e)
+        return;
+    }
+    riserva_indice(_size + n);
+    for (; b != e; ++b)
+      accoda(*b, _indice.calcola(*b));
+  }
+
+public:
+  /**
+   * @brief operatore di unione su una set temporanea
+   * Come operator+, ma i nodi di s1 vengono riusati invece che copiati, e
+   * gli elementi di s2 vengono accodati con operator+=, che riusa gli
+   * hash dei nodi di s2.
+   * @param s1 prima set, temporanea
+   * @param s2 seconda set
+   * @return una set con tutti gli elementi di entrambe senza duplicati
+   */
+  friend set operator+(set &&s1, const set &s2)
+  {
+    s1 += s2;
+    return std::move(s1);
+  }
+
+  /**
+   * @brief operatore di intersezione su una set temporanea
+   * Come operator-, ma il risultato è ottenuto togliendo da s1 gli
+   * elementi che non sono in s2, senza allocare nuovi nodi.
+   * @param s1 prima set, temporanea
+   * @param s2 seconda set
+   * @return set con elementi comuni tra le due set s1 e s2
+   */
+  friend set operator-(set &&s1, const set &s2)
+  {
+    set s3(std::move(s1));
+    s3.rimuovi_nodi_se([&s2](const nodo *n) { return !s2.contiene(n); });
+    return s3;
+  }
+
+  /**
+   * @brief Unione sul posto
+   * Accoda gli elementi di other che mancano in questa set, senza
+   * copiarla. In caso di eccezione restano gli elementi già aggiunti.
+   * @param other set da unire
+   * @return reference a this
+   */
+  set &operator+=(const set &other)
+  {
+    if (this != &other)
+    {
+      riserva_indice(_size + other._size);
+      for (nodo *curr = other._head; curr != nullptr; curr = curr->next)
+        if (!contiene(curr))
+          accoda(curr->valore, curr->hash());
+        else
+          contatori().duplicato();
+    }
+    return *this;
+  }
+
+  /**
+   * @brief Intersezione sul posto
+   * Toglie in una passata gli elementi che non sono in other
+   * @param other set da intersecare
+   * @return reference a this
+   */
+  set &operator-=(const set &other)
+  {
+    if (this != &other)
+      rimuovi_nodi_se([&other](const nodo *n) { return !other.contiene(n); });
+    return *this;
+  }
+
+  /**
+   * @brief Differenza sul posto
+   * Toglie in una passata gli elementi che sono anche in other
+   * @param other set degli elementi da togliere
+   * @return reference a this
+   */
+  set &togli(const set &other)
+  {
+    if (this == &other)
+      svuota();
+    else
+      rimuovi_nodi_se([&other](const nodo *n) { return other.contiene(n); });
+    return *this;
+  }
+
+  /**
+   * @brief Differenza simmetrica sul posto
+   * Ogni elemento di other viene tolto se presente e accodato se
+   * assente. In caso di eccezione la set resta valida ma modificata
+   * solo in parte.
+   * @param other set con cui fare la differenza simmetrica
+   * @return reference a this
+   */
+  set &alterna(const set &other)
+  {
+    if (this == &other)
+    {
+      svuota();
+      return *this;
+    }
+    riserva_indice(_size + other._size);
+    for (nodo *curr = other._head; curr != nullptr; curr = curr->next)
+    {
+      std::size_t h = curr->hash();
+      nodo *n = trova_nodo(curr->valore, h);
+      if (n == nullptr)
+        accoda(curr->valore, h);
+      else
+      {
+        disindicizza(n, h);
+        elimina(n);
+        contatori().rimozione();
+      }
+    }
+    return *this;
+  }
+
+  /**
+   * @brief Differenza
+   * Funzione GLOBALE che ritorna gli elementi di s1 che non sono in s2,
+   * nell'ordine di s1. Gli elementi vengono accodati senza ricerche.
+   * @param s1 prima set
+   * @param s2 set degli elementi da escludere
+   * @return set con gli elementi di s1 che non sono in s2
+   */
+  friend set differenza(const set &s1, const set &s2)
+  {
+    set s3;
+    for (nodo *curr = s1._head; curr != nullptr; curr = curr->next)
+      if (!s2.contiene(curr))
+        s3.accoda(curr->valore, curr->hash());
+    return s3;
+  }
+
+  /**
+   * @brief Differenza su una set temporanea
+   * Come differenza, ma il risultato è ottenuto togliendo da s1 gli
+   * elementi di s2, senza allocare nuovi nodi.
+   * @param s1 prima set, temporanea
+   * @param s2 set degli elementi da escludere
+   * @return set con gli elementi di s1 che non sono in s2
+   */
+  friend set differenza(set &&s1, const set &s2)
+  {
+    set s3(std::move(s1));
+    s3.togli(s2);
+    return s3;
+  }
+
+  /**
+   * @brief Differenza simmetrica
+   * Funzione GLOBALE che ritorna gli elementi che sono in una sola delle
+   * due set: prima quelli di s1, poi quelli di s2. Gli elementi vengono
+   * accodati senza ricerche.
+   * @param s1 prima set
+   * @param s2 seconda set
+   * @return set con gli elementi di s1 o di s2 ma non di entrambe
+   */
+  friend set differenza_simmetrica(const set &s1, const set &s2)
+  {
+    set s3;
+    for (nodo *curr = s1._head; curr != nullptr; curr = curr->next)
+      if (!s2.contiene(curr))
+        s3.accoda(curr->valore, curr->hash());
+    for (nodo *curr = s2._head; curr != nullptr; curr = curr->next)
+      if (!s1.contiene(curr))
+        s3.accoda(curr->valore, curr->hash());
+    return s3;
+  }
+
+  /**
+   * @brief Differenza simmetrica su una set temporanea
+   * Come differenza_simmetrica, ma riusa i nodi di s1
+   * @param s1 prima set, temporanea
+   * @param s2 seconda set
+   * @return set con gli elementi di s1 o di s2 ma non di entrambe
+   */
+  friend set differenza_simmetrica(set &&s1, const set &s2)
+  {
+    set s3(std::move(s1));
+    s3.alterna(s2);
+    return s3;
+  }
+
+  /**
+   * @brief filter_out
+   * Funzione GLOBALE che permette di applicare una condizione (predicato)
+   * agli elementi della set restituendo solo quelli che la rispettano.
+   * Gli elementi di S sono distinti, quindi vengono accodati senza
+   * ricerche e il costo è lineare.
+   * @param S set su cui applicare il predicato
+   * @param predicato predicato da applicare
+   * @return una set con gli elementi che verificano il predicato
+   */
+  template <typename P>
+  friend set filter_out(const set &S, P predicato)
+  {
+    set s1;
+    for (nodo *curr = S._head; curr != nullptr; curr = curr->next)
+      if (predicato(curr->valore))
+        s1.accoda(curr->valore, curr->hash());
+    return s1;
+  }
+
+  /**
+   * @brief erase_if
+   * Funzione GLOBALE che toglie da S, sul posto e in una sola passata,
+   * gli elementi che soddisfano il predicato, come std::erase_if.
+   * È il complemento di filter_out senza costruire una seconda set:
+   * erase_if(S, p) lascia in S gli elementi che filter_out(S, p) scarta.
+   * @param S set da cui togliere gli elementi
+   * @param predicato predicato da applicare
+   * @return il numero di elementi tolti
+   */
+  template <typename P>
+  friend unsigned int erase_if(set &S, P predicato)
+  {
+    return S.rimuovi_se(predicato);
+  }
+
+  /**
+   * @brief filter_out su una set temporanea
+   * Come filter_out, ma il risultato è ottenuto togliendo da S gli
+   * elementi che non soddisfano il predicato, senza allocare nuovi nodi.
+   * @param S set temporanea su cui applicare il predicato
+   * @param predicato predicato da applicare
+   * @return una set con gli elementi che verificano il predicato
+   */
+  template <typename P>
+  friend set filter_out(set &&S, P predicato)
+  {
+    set s1(std::move(S));
+    s1.rimuovi_se([&predicato](const T &v) { return !predicato(v); });
+    return s1;
+  }
+
+  /**
+   * @brief operatore di unione parallelo
+   * Come operator+, ma la ricerca in s1 degli elementi di s2 è divisa tra
+   * i thread della politica. Il risultato viene poi costruito accodando
+   * gli elementi senza altre ricerche, nello stesso ordine di operator+.
+   * @param p politica di esecuzione
+   * @param s1 prima set
+   * @param s2 seconda set
+   * @return una set con tutti gli elementi di entrambe senza duplicati
+   */
+  friend set unione(const parallelo &p, const set &s1, const set &s2)
+  {
+    std::vector<char> nuovi;
+    set_dettagli::marca_in_parallelo(s2.begin(), s2._size, p.thread,
+                                     [&s1](const T &v) { return !s1.cerca(v); }, nuovi);
+    set s3;
+    s3.riserva_indice(s1._size + s2._size);
+    for (nodo *curr = s1._head; curr != nullptr; curr = curr->next)
+      s3.accoda(curr->valore, curr->hash());
+    s3.accoda_marcati(s2.begin(), nuovi);
+    return s3;
+  }
+
+  /**
+   * @brief operatore di intersezione parallelo
+   * Come operator-, ma la ricerca in s2 degli elementi di s1 è divisa tra
+   * i thread della politica.
+   * @param p politica di esecuzione
+   * @param s1 prima set
+   * @param s2 seconda set
+   * @return set con elementi comuni tra le due set s1 e s2
+   */
+  friend set intersezione(const parallelo &p, const set &s1, const set &s2)
+  {
+    std::vector<char> comuni;
+    set_dettagli::marca_in_parallelo(s1.begin(), s1._size, p.thread,
+                                     [&s2](const T &v) { return s2.cerca(v); }, comuni);
+    set s3;
+    s3.accoda_marcati(s1.begin(), comuni);
+    return s3;
+  }
+
+  /**
+   * @brief filter_out parallelo
+   * Come filter_out, ma il predicato viene valutato in parallelo sui
+   * thread della politica; ogni thread usa una propria copia del
+   * predicato, che deve poter essere chiamato da più thread.
+   * @param p politica di esecuzione
+   * @param S set su cui applicare il predicato
+   * @param predicato predicato da applicare
+   * @return una set con gli elementi che verificano il predicato
+   */
+  template <typename P>
+  friend set filter_out(const parallelo &p, const set &S, P predicato)
+  {
+    std::vector<char> scelti;
+    set_dettagli::marca_in_parallelo(S.begin(), S._size, p.thread, predicato, scelti);
+    set s1;
+    s1.accoda_marcati(S.begin(), scelti);
+    return s1;
+  }
+
+  /**
+   Gli iteratori devono iterare su elementi inseriti nella classe
+   principale. Siccome nella set mettiamo dei elementi di 
+   tipo T, l'iteratore deve iterare sui dati di tipo T.
+   */
+  class const_iterator
+  {
+
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef ptrdiff_t difference_type;
+    typedef const T *pointer;
+    typedef const T &reference;
+
+    const_iterator() : ptr(nullptr)
+    {
+    }
+
+    const_iterator(const const_iterator &other) : ptr(other.ptr)
+    {
+    }
+
+    const_iterator &operator=(const const_iterator &other)
+    {
+      ptr = other.ptr;
+      return *this;
+    }
+
+    ~const_iterator() {}
+
+    // Ritorna il dato riferito dall'iteratore (dereferenziamento)
+    reference operator*() const
+    {
+      return ptr->valore;
+    }
+
+    // Ritorna il puntatore al dato riferito dall'iteratore
+    pointer operator->() const
+    {
+      return &(ptr->valore);
+    }
+
+    // Operatore di iterazione post-incremento
+    const_iterator operator++(int)
+    {
+      const_iterator tmp(*this);
+      ptr = ptr->next;
+      return tmp;
+    }
+
+    // Operatore di iterazione pre-incremento
+    const_iterator &operator++()
+    {
+      ptr = ptr->next;
+      return *this;
+    }
+
+    // Uguaglianza
+    bool operator==(const const_iterator &other) const
+    {
+      return (ptr == other.ptr);
+    }
+
+    // Diversita'
+    bool operator!=(const const_iterator &other) const
+    {
+      return !(other == *this);
+    }
+
+  private:
+    // La classe container deve essere messa friend dell'iteratore per poter
+    // usare il costruttore di inizializzazione.
+    friend class set;
+
+    // Costruttore privato di inizializzazione usato dalla classe container
+    // tipicamente nei metodi begin e end
+    const_iterator(const nodo *p) : ptr(p) {}
+
+    const nodo *ptr;
+
+    // !!! Eventuali altri metodi privati
+
+  }; // classe const_iterator
+
+  // Ritorna l'iteratore all'inizio della sequenza dati
+  const_iterator begin() const
+  {
+    return const_iterator(_head);
+  }
+
+  // Ritorna l'iteratore alla fine della sequenza dati
+  const_iterator end() const
+  {
+    return const_iterator(nullptr);
+  }
+
+  /**
+   * @brief Cerca un valore passato
+   * Cerca se un valore passato è presente nella lista. Usa il
+     funtore Eql.
+   * @param valore valore da cercare nella lista
+   * @return true se il valore è stato trovato
+   * @return false altrimenti
+   */
+  bool cerca(const T &valore) const
+  {
+    return trova_nodo(valore, _indice.calcola(valore)) != nullptr;
+  }
+
+  /**
+   * @brief Impronta della set
+   * Dipende solo dagli elementi e non dall'ordine di inserimento, ed è
+   * mantenuta da add, remove e svuota senza ripercorrere la set: set
+   * uguali hanno la stessa impronta. È l'hash usato da std::hash<set>.
+   * Disponibile solo con Hash.
+   * @return l'impronta degli elementi
+   */
+  std::size_t impronta() const
+  {
+    static_assert(indice::attivo, "impronta richiede una set con Hash");
+    return set_dettagli::mescola(_impronta.valore() + _size);
+  }
+
+  /**
+   * @brief Operatore di uguaglianza
+   * Controlla se due liste sono uguali tramite il funtore Eql.
+   * Con Hash due set con impronte diverse vengono scartate in O(1),
+   * altrimenti la conferma cerca ogni elemento nell'indice dell'altra, in
+   * O(n) atteso.
+   * @param other lista da comparare
+   * @return true se le due liste sono uguali
+   * @return false altrimenti
+   */
+  bool operator==(const set &other) const
+  {
+    bool equal = true;
+    nodo *curr = _head;
+    if (size() == 0 && other.size() == 0)
+    {
+      return true;
+    }
+    if (size() == 0 && other.size() != 0)
+    {
+      return false;
+    }
+    if (size() != 0 && other.size() == 0)
+    {
+      return false;
+    }
+    if (size() != other.size())
+    {
+      return false;
+    }
+    if (_impronta.valore() != other._impronta.valore())
+    {
+      return false;
+    }
+    if (size() == other.size())
+    {
+      while (curr != nullptr && equal)
+      {
+        if (!other.contiene(curr))
+        {
+          return false;
+        }
+        else
+          curr = curr->next;
+      }
+      return equal;
+    }
+    return equal;
+  }
+  /**
+   * @brief Operatore[]
+   * Permette di estrarre dalla lista un elemento in una posizione passata nella funzione.
+   * La prima chiamata dopo una remove ricostruisce l'indice posizionale in O(n),
+   * le successive sono O(1). Aggiornando l'indice, chiamate concorrenti
+   * sulla stessa set non sono sicure.
+   * @param i posizione dell'elemento che si vuole estrarre
+   * @return  elemento in posizione i
+   */
+  const T &operator[](int i) const
+  {
+    assert(i >= 0 && static_cast<unsigned int>(i) < size());
+    if (static_cast<unsigned int>(i) >= _posizioni.size())
+    {
+      const nodo *curr = _posizioni.empty() ? _head : _posizioni.back()->next;
+      _posizioni.reserve(_size);
+      while (curr != nullptr)
+      {
+        _posizioni.push_back(curr);
+        curr = curr->next;
+      }
+    }
+    return _posizioni[i]->valore;
+  }
+};
+
+namespace set_dettagli
+{
+  struct op_unione {};       ///< operazione di un'espressione: unione
+  struct op_intersezione {}; ///< operazione di un'espressione: intersezione
+
+  /**
+    @brief Descrizione di un operando di un'espressione insiemistica
+
+    Definita solo per set ed espressioni, così gli operatori + e -
+    generici non vengono considerati per altri tipi.
+    - tipo: set risultato dell'espressione
+    - massimo: limite superiore alla dimensione dell'operando
+  */
+  template <typename X>
+  struct operando
+  {
+  };
+
+  template <typename T, typename Eql, typename Hash, typename Stats, std::size_t N>
+  struct operando<set<T, Eql, Hash, Stats, N> >
+  {
+    typedef set<T, Eql, Hash, Stats, N> tipo;
+
+    static std::size_t massimo(const tipo &s) { return s.size(); }
+  };
+
+  /**
+   * @brief Indica se X è una set
+   */
+  template <typename X>
+  struct e_set : std::false_type
+  {
+  };
+
+  template <typename T, typename Eql, typename Hash, typename Stats, std::size_t N>
+  struct e_set<set<T, Eql, Hash, Stats, N> > : std::true_type
+  {
+  };
+
+  /**
+   * @brief Come un'espressione conserva l'operando A
+   * A è dedotto da un riferimento universale: le set lvalue vengono
+   * tenute per riferimento, le set temporanee e le sotto-espressioni per
+   * valore.
+   */
+  template <typename A, bool = e_set<typename std::decay<A>::type>::value && std::is_lvalue_reference<A>::value>
+  struct memorizzato
+  {
+    typedef typename std::decay<A>::type type;
+  };
+
+  template <typename A>
+  struct memorizzato<A, true>
+  {
+    typedef const typename std::decay<A>::type &type;
+  };
+
+  /**
+   * @brief Tipo dell'espressione A op B
+   * Definito solo se A e B sono operandi con lo stesso tipo di set e A
+   * non è una set temporanea modificabile: in quel caso vengono usati
+   * operator+(set &&, const set &) e operator-(set &&, const set &).
+   */
+  template <typename A, typename B, typename Op,
+            bool = std::is_same<typename operando<typename std::decay<A>::type>::tipo,
+                                typename operando<typename std::decay<B>::type>::tipo>::value &&
+                   !(e_set<typename std::decay<A>::type>::value && !std::is_reference<A>::value &&
+                     !std::is_const<A>::value)>
+  struct espressione_di
+  {
+  };
+}
+
+/**
+  @brief Espressione insiemistica non ancora valutata
+
+  Risultato di operator+ e operator- su set e su altre espressioni,
+  quando il primo operando non è una set temporanea. Conserva solo gli operandi: (a + b) - c non costruisce
+  set intermedie, e gli elementi vengono calcolati solo quando
+  l'espressione viene iterata, interrogata con cerca o size, o convertita
+  in S. La conversione percorre il risultato una volta sola e accoda gli
+  elementi senza cercare duplicati, quindi alloca solo la set finale.
+
+  Gli elementi seguono lo stesso ordine degli operatori eager: per
+  l'unione prima quelli del primo operando, poi quelli del secondo
+  che mancano nel primo; per l'intersezione quelli del primo operando
+  presenti nel secondo.
+
+  Regola di durata: le set operando lvalue sono tenute per riferimento,
+  mentre le set temporanee e le sotto-espressioni vengono spostate
+  nell'espressione. Un'espressione conservata con auto resta quindi
+  valida finché esistono le set con nome che usa, e riflette le loro
+  modifiche successive; auto x = a + crea_set(); è sicuro, perché la set
+  temporanea vive dentro x.
+  L e R sono i tipi memorizzati (const S & oppure valori).
+*/
+template <typename S, typename L, typename R, typename Op>
+class espressione_set
+{
+  typedef typename S::const_iterator::value_type T;
+
+  typedef typename std::decay<L>::type tipo_l; ///< tipo del primo operando
+  typedef typename std::decay<R>::type tipo_r; ///< tipo del secondo operando
+
+  L _l; ///< primo operando
+  R _r; ///< secondo operando
+
+  /**
+   * @brief Appartenenza al risultato
+   */
+  bool contiene(const T &v, set_dettagli::op_unione) const
+  {
+    return _l.cerca(v) || _r.cerca(v);
+  }
+
+  bool contiene(const T &v, set_dettagli::op_intersezione) const
+  {
+    return _l.cerca(v) && _r.cerca(v);
+  }
+
+  /**
+   * @brief Limite superiore alla dimensione del risultato
+   */
+  std::size_t massimo(set_dettagli::op_unione) const
+  {
+    return set_dettagli::operando<tipo_l>::massimo(_l) + set_dettagli::operando<tipo_r>::massimo(_r);
+  }
+
+  std::size_t massimo(set_dettagli::op_intersezione) const
+  {
+    return std::min(set_dettagli::operando<tipo_l>::massimo(_l), set_dettagli::operando<tipo_r>::massimo(_r));
+  }
+
+public:
+  /**
+   * @brief Costruttore
+   * @param l primo operando, spostato se temporaneo
+   * @param r secondo operando, spostato se temporaneo
+   */
+  template <typename LL, typename RR>
+  espressione_set(LL &&l, RR &&r) : _l(std::forward<LL>(l)), _r(std::forward<RR>(r)) {}
+
+  /**
+   Iteratore in sola lettura sul risultato, calcolato durante lo
+   scorrimento: avanzare costa le ricerche necessarie a scartare gli
+   elementi che non fanno parte del risultato.
+   */
+  class const_iterator
+  {
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef ptrdiff_t difference_type;
+    typedef const T *pointer;
+    typedef const T &reference;
+
+    const_iterator() : _e(nullptr) {}
+
+    reference operator*() const
+    {
+      return _il != _fl ? *_il : *_ir;
+    }
+
+    pointer operator->() const
+    {
+      return &**this;
+    }
+
+    const_iterator &operator++()
+    {
+      if (_il != _fl)
+        ++_il;
+      else
+        ++_ir;
+      salta(Op());
+      return *this;
+    }
+
+    const_iterator operator++(int)
+    {
+      const_iterator tmp(*this);
+      ++*this;
+      return tmp;
+    }
+
+    bool operator==(const const_iterator &other) const
+    {
+      return _il == other._il && _ir == other._ir;
+    }
+
+    bool operator!=(const const_iterator &other) const
+    {
+      return !(other == *this);
+    }
+
+  private:
+    friend class espressione_set;
+
+    typedef typename tipo_l::const_iterator iter_l;
+    typedef typename tipo_r::const_iterator iter_r;
+
+    const espressione_set *_e; ///< espressione iterata
+    iter_l _il, _fl;           ///< posizione e fine nel primo operando
+    iter_r _ir, _fr;           ///< posizione e fine nel secondo operando
+
+    // Per l'intersezione il secondo operando non viene scorso e
+    // _ir resta sempre alla sua fine.
+    const_iterator(const espressione_set *e, iter_l il, iter_l fl, iter_r ir, iter_r fr)
+        : _e(e), _il(il), _fl(fl), _ir(ir), _fr(fr)
+    {
+      salta(Op());
+    }
+
+    // Porta l'iteratore sul prossimo elemento del risultato
+    void salta(set_dettagli::op_unione)
+    {
+      if (_il == _fl)
+        while (_ir != _fr && _e->_l.cerca(*_ir))
+          ++_ir;
+    }
+
+    void salta(set_dettagli::op_intersezione)
+    {
+      while (_il != _fl && !_e->_r.cerca(*_il))
+        ++_il;
+    }
+  };
+
+  // Ritorna l'iteratore al primo elemento del risultato
+  const_iterator begin() const
+  {
+    return const_iterator(this, _l.begin(), _l.end(),
+                          std::is_same<Op, set_dettagli::op_unione>::value ? _r.begin() : _r.end(), _r.end());
+  }
+
+  // Ritorna l'iteratore alla fine del risultato
+  const_iterator end() const
+  {
+    return const_iterator(this, _l.end(), _l.end(), _r.end(), _r.end());
+  }
+
+  /**
+   * @brief Cerca un valore nel risultato senza calcolarlo
+   * @param valore valore da cercare
+   * @return true se il valore fa parte del risultato
+   */
+  bool cerca(const T &valore) const
+  {
+    return contiene(valore, Op());
+  }
+
+  /**
+   * @brief Dimensione del risultato
+   * Scorre il risultato senza costruirlo: ogni chiamata costa le stesse
+   * ricerche di una visita completa. Per chiamarla più volte, ad esempio
+   * in un ciclo, conviene valutare prima l'espressione in una S.
+   * @return il numero di elementi del risultato
+   */
+  unsigned int size() const
+  {
+    unsigned int n = 0;
+    for (const_iterator i = begin(), e = end(); i != e; ++i)
+      ++n;
+    return n;
+  }
+
+  /**
+   * @brief Limite superiore alla dimensione, senza scorrere il risultato
+   * @return somma (unione) o minimo (intersezione) dei limiti degli operandi
+   */
+  std::size_t massimo() const
+  {
+    return massimo(Op());
+  }
+
+  /**
+   * @brief Valuta l'espressione
+   * Gli elementi del risultato sono già distinti, quindi vengono
+   * accodati senza ricerche.
+   * @return la set risultato
+   */
+  operator S() const
+  {
+    S s;
+    s.accoda_sequenza(begin(), end(), massimo());
+    return s;
+  }
+
+  /**
+   * @brief Confronto con una set
+   * @param other set da comparare
+   * @return true se il risultato è uguale a other
+   */
+  bool operator==(const S &other) const
+  {
+    return S(*this) == other;
+  }
+};
+
+namespace set_dettagli
+{
+  template <typename S, typename L, typename R, typename Op>
+  struct operando<espressione_set<S, L, R, Op> >
+  {
+    typedef S tipo;
+
+    static std::size_t massimo(const espressione_set<S, L, R, Op> &e) { return e.massimo(); }
+  };
+
+  template <typename A, typename B, typename Op>
+  struct espressione_di<A, B, Op, true>
+  {
+    typedef espressione_set<typename operando<typename std::decay<A>::type>::tipo,
+                            typename memorizzato<A>::type, typename memorizzato<B>::type, Op>
+        type;
+  };
+}
+
+/**
+ * @brief operatore di unione
+ * Funzione che permette di unire due liste senza duplicati.
+ * Gli operandi sono set o altre espressioni dello stesso tipo di set; il
+ * risultato è un'espressione valutata solo quando serve (vedi
+ * espressione_set). Se s1 è una set temporanea viene invece usato
+ * operator+(set &&, const set &), che calcola subito il risultato.
+ * @param s1 prima set o espressione
+ * @param s2 seconda set o espressione, spostata se temporanea
+ * @return espressione con tutti gli elementi di entrambe le liste senza
+ * duplicati
+ */
+template <typename A, typename B>
+typename set_dettagli::espressione_di<A, B, set_dettagli::op_unione>::type
+operator+(A &&s1, B &&s2)
+{
+  return typename set_dettagli::espressione_di<A, B, set_dettagli::op_unione>::type(std::forward<A>(s1),
+                                                                                    std::forward<B>(s2));
+}
+
+/**
+ * @brief operatore di intersezione
+ * Funzione che permette di ottenere gli elementi comuni a due set o
+ * espressioni dello stesso tipo di set; il risultato è un'espressione
+ * valutata solo quando serve (vedi espressione_set). Se s1 è una set
+ * temporanea viene invece usato operator-(set &&, const set &).
+ * @param s1 prima set o espressione
+ * @param s2 seconda set o espressione, spostata se temporanea
+ * @return espressione con gli elementi comuni tra s1 e s2
+ */
+template <typename A, typename B>
+typename set_dettagli::espressione_di<A, B, set_dettagli::op_intersezione>::type
+operator-(A &&s1, B &&s2)
+{
+  return typename set_dettagli::espressione_di<A, B, set_dettagli::op_intersezione>::type(std::forward<A>(s1),
+                                                                                          std::forward<B>(s2));
+}
+
+namespace std
+{
+  /**
+   * @brief Hash di una set
+   * Con Hash usa l'impronta mantenuta dalla set, quindi costa O(1) e
+   * permette di usare le set come chiavi di contenitori hash o come
+   * elementi di altre set senza ripercorrerne il contenuto. Senza Hash è
+   * disabilitato come std::hash dei tipi senza hash.
+   */
+  template <typename T, typename Eql, typename Hash, typename Stats, std::size_t N>
+  struct hash< ::set<T, Eql, Hash, Stats, N> >
+      : set_dettagli::hash_set< ::set<T, Eql, Hash, Stats, N>, !is_void<Hash>::value>
+  {
+  };
+}
 #endif
\ No newline at end of file
@@ -0,0 +1,253 @@
+#ifndef SNAPSHOT_SET_H
+#define SNAPSHOT_SET_H
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <cstddef>
+#include "set.h"
+
+/**
+  @brief classe snapshot_set
+
+  Insieme per carichi a lettura prevalente. I lettori lavorano su una
+  versione immutabile di set<T, Eql, Hash> senza prendere lock e senza
+  mai aspettare: la lettura costa un incremento e un decremento atomico
+  di un contatore. Lo scrittore copia la versione corrente, la modifica,
+  pubblica la nuova con uno scambio atomico del puntatore e libera la
+  vecchia solo dopo che tutti i lettori che potevano vederla hanno finito
+  (riclamazione a epoche, come SRCU).
+  Ogni modifica copia l'intero insieme (O(n)): per più modifiche insieme
+  conviene modifica(), che paga una sola copia.
+*/
+template <typename T, typename Eql, typename Hash = void>
+class snapshot_set
+{
+public:
+  typedef set<T, Eql, Hash> versione; ///< tipo delle versioni pubblicate
+
+private:
+  /// numero di contatori di lettori per epoca, per ridurre la contesa
+  static const std::size_t n_strisce = 16;
+
+  /**
+   * @brief Contatore di lettori attivi, su una propria linea di cache
+   */
+  struct striscia
+  {
+    std::atomic<long> lettori; ///< lettori entrati e non ancora usciti
+    char riempimento[64 - sizeof(std::atomic<long>)]; ///< separa le strisce
+  };
+
+  std::atomic<const versione *> _corrente;   ///< versione pubblicata
+  std::atomic<unsigned long> _epoca;         ///< la parità sceglie i contatori
+  striscia _strisce[2][n_strisce];           ///< lettori attivi per parità
+  std::mutex _scrittura;                     ///< serializza gli scrittori
+
+  snapshot_set(const snapshot_set &other);
+  snapshot_set &operator=(const snapshot_set &other);
+
+  /**
+   * @brief Striscia usata dal thread chiamante
+   * @return indice della striscia, fisso per ogni thread
+   */
+  static std::size_t mia_striscia()
+  {
+    static thread_local std::size_t s = std::hash<std::thread::id>()(std::this_thread::get_id()) % n_strisce;
+    return s;
+  }
+
+  /**
+   * @brief Aspetta che escano i lettori entrati con una data parità
+   * @param p parità da svuotare
+   */
+  void aspetta_lettori(unsigned long p)
+  {
+    for (std::size_t i = 0; i < n_strisce; ++i)
+      while (_strisce[p][i].lettori.load() != 0)
+        std::this_thread::yield();
+  }
+
+  /**
+   * @brief Pubblica una nuova versione e libera la precedente
+   * Dopo lo scambio del puntatore l'epoca avanza due volte, aspettando
+   * ogni volta i lettori della parità abbandonata: un lettore che ha letto
+   * l'epoca prima dello scambio ma si è registrato dopo la prima attesa
+   * vede già la nuova versione, e la seconda attesa copre quelli entrati
+   * tra i due avanzamenti.
+   * Va chiamata con _scrittura bloccato.
+   * @param nuova versione da pubblicare
+   */
+  void pubblica(const versione *nuova)
+  {
+    const versione *vecchia = _corrente.exchange(nuova);
+    for (int giro = 0; giro < 2; ++giro)
+      aspetta_lettori(_epoca.fetch_add(1) & 1);
+    delete vecchia;
+  }
+
+public:
+  /**
+   * @brief Accesso in lettura a una versione
+   * Finché l'oggetto esiste la versione non viene liberata. Va usato da un
+   * solo thread e tenuto per poco: uno scrittore aspetta che venga
+   * distrutto prima di liberare la versione, quindi lo stesso thread non
+   * deve modificare l'insieme mentre ha una lettura aperta.
+   * Le funzioni const di set sono sicure tra lettori concorrenti, tranne
+   * operator[], che aggiorna un indice interno.
+   */
+  class lettura
+  {
+    const versione *_v;      ///< versione letta
+    std::atomic<long> *_c;   ///< contatore da decrementare all'uscita
+
+    lettura(const lettura &other);
+    lettura &operator=(const lettura &other);
+
+  public:
+    /**
+     * @brief Entra in lettura
+     * @param s insieme da leggere
+     */
+    explicit lettura(const snapshot_set &s)
+    {
+      snapshot_set &m = const_cast<snapshot_set &>(s);
+      _c = &m._strisce[m._epoca.load() & 1][mia_striscia()].lettori;
+      _c->fetch_add(1);
+      _v = m._corrente.load();
+    }
+
+    /**
+     * @brief Move constructor
+     * @param other lettura da cui prendere la versione
+     */
+    lettura(lettura &&other) noexcept : _v(other._v), _c(other._c)
+    {
+      other._c = nullptr;
+    }
+
+    /**
+      Distruttore, esce dalla lettura
+    */
+    ~lettura()
+    {
+      if (_c != nullptr)
+        _c->fetch_sub(1);
+    }
+
+    const versione &operator*() const
+    {
+      return *_v;
+    }
+
+    const versione *operator->() const
+    {
+      return _v;
+    }
+  };
+
+  /**
+   * @brief Costruttore di default
+   * @post size() == 0
+   */
+  snapshot_set() : _corrente(new versione()), _epoca(0)
+  {
+    for (int p = 0; p < 2; ++p)
+      for (std::size_t i = 0; i < n_strisce; ++i)
+        _strisce[p][i].lettori.store(0);
+  }
+
+  /**
+    Distruttore. Non devono esserci letture in corso.
+  */
+  ~snapshot_set()
+  {
+    delete _corrente.load();
+  }
+
+  /**
+   * @brief Legge la versione corrente
+   * @return accesso in lettura alla versione corrente
+   */
+  lettura leggi() const
+  {
+    return lettura(*this);
+  }
+
+  /**
+   * @brief Cerca un valore nella versione corrente
+   * @param valore valore da cercare
+   * @return true se il valore è presente
+   * @return false altrimenti
+   */
+  bool cerca(const T &valore) const
+  {
+    lettura l(*this);
+    return l->cerca(valore);
+  }
+
+  /**
+   * @brief Dimensione della versione corrente
+   * @return il numero di elementi
+   */
+  unsigned int size() const
+  {
+    lettura l(*this);
+    return l->size();
+  }
+
+  /**
+   * @brief Modifica l'insieme con una sola copia
+   * f riceve una copia modificabile della versione corrente, che viene
+   * pubblicata al ritorno. Se f lancia un'eccezione la versione corrente
+   * resta quella di prima e l'eccezione viene rilanciata.
+   * @param f funzione che modifica la copia
+   */
+  template <typename F>
+  void modifica(F f)
+  {
+    std::lock_guard<std::mutex> guardia(_scrittura);
+    versione *nuova = new versione(*_corrente.load());
+    try
+    {
+      f(*nuova);
+    }
+    catch (...)
+    {
+      delete nuova;
+      throw;
+    }
+    pubblica(nuova);
+  }
+
+  /**
+   * @brief Aggiunge un elemento e pubblica una nuova versione
+   * @param v valore da inserire
+   */
+  void add(const T &v)
+  {
+    modifica([&v](versione &s) { s.add(v); });
+  }
+
+  /**
+   * @brief Rimuove un elemento e pubblica una nuova versione
+   * @param v valore da rimuovere
+   */
+  void remove(const T &v)
+  {
+    modifica([&v](versione &s) { s.remove(v); });
+  }
+
+  /**
+   * @brief Sostituisce il contenuto con una set già pronta
+   * @param s nuova versione, presa per spostamento
+   */
+  void sostituisci(versione &&s)
+  {
+    std::lock_guard<std::mutex> guardia(_scrittura);
+    pubblica(new versione(std::move(s)));
+  }
+};
+
+#endif